@@ -0,0 +1,100 @@
+/*
+ * Example test plugin: a float dot product kept in L1, built by the Makefile
+ * into plugins/ and picked up by the executable at startup. It is written
+ * like a built-in test and only adds the exported plugin table.
+ */
+#include <cmath>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "Logger.hpp"
+#include "Plugin.hpp"
+#include "TestRegistry.hpp"
+
+#define DOT_PRODUCT_LENGTH 4096  // Two 16 KB vectors, both fit in L1
+
+class DotProductTest : public BatchedTest<DotProductTest> {
+public:
+	DotProductTest() : BatchedTest("plugin_dot_product_test") {}
+
+	void SetUp() override {
+		Xoshiro256 gen = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM);
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+		m_X.resize(DOT_PRODUCT_LENGTH);
+		m_Y.resize(DOT_PRODUCT_LENGTH);
+		for (size_t i = 0; i < DOT_PRODUCT_LENGTH; i++) {
+			m_X[i] = dist(gen);
+			m_Y[i] = dist(gen);
+		}
+	}
+
+	void TearDown() override {
+		m_X = std::vector<float>();
+		m_Y = std::vector<float>();
+	}
+
+	void Run() override {
+		float sum = 0.0f;
+		ThreadContext& context = GetThreadContext(0);
+		for (int64_t iter = 0; iter < m_IterationCount; ++iter)
+			sum += Iteration(context);
+		DoNotOptimize(sum);
+	}
+
+	void Verify() override {
+		if (m_X.empty())
+			return;
+
+		double expected = 0.0;
+		double magnitude = 0.0;
+		for (size_t i = 0; i < DOT_PRODUCT_LENGTH; i++) {
+			expected += static_cast<double>(m_X[i]) * m_Y[i];
+			magnitude += std::abs(static_cast<double>(m_X[i]) * m_Y[i]);
+		}
+
+		ThreadContext context = CreateThreadContext(0);
+		ExpectNear("dot product", Iteration(context), expected, DOT_PRODUCT_LENGTH * 1.2e-7 * magnitude);
+	}
+
+	WorkPerIteration GetWork() const override {
+		WorkPerIteration work;
+		work.unit = WorkUnit::FLOP;
+		work.amount = 2.0 * DOT_PRODUCT_LENGTH;
+		work.bytes = 2.0 * DOT_PRODUCT_LENGTH * sizeof(float);
+		return work;
+	}
+
+	float Iteration(ThreadContext&) {
+		/* Four partial sums, so the loop is not one long dependency chain */
+		float partial[4] = {};
+		for (size_t i = 0; i < DOT_PRODUCT_LENGTH; i += 4) {
+			for (size_t lane = 0; lane < 4; lane++)
+				partial[lane] += m_X[i + lane] * m_Y[i + lane];
+		}
+		return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+	}
+
+private:
+	std::vector<float> m_X;
+	std::vector<float> m_Y;
+};
+
+static BenchmarkTest* CreateDotProductTest(const BenchmarkPluginParams*) {
+	return new (std::nothrow) DotProductTest();
+}
+
+static const BenchmarkPluginTest s_Tests[] = {
+	{ "plugin_dot_product_test", "scalar", TEST_MODE_ALL, "Example plugin: FP32 dot product of two L1-resident vectors", CreateDotProductTest },
+};
+
+static const BenchmarkPluginInfo s_Info = {
+	BENCHMARK_PLUGIN_ABI_VERSION,
+	"example-dot-product",
+	sizeof(s_Tests) / sizeof(s_Tests[0]),
+	s_Tests,
+};
+
+BENCHMARK_PLUGIN_EXPORT const BenchmarkPluginInfo* BenchmarkPluginGetInfo(void) {
+	return &s_Info;
+}
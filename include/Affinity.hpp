@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "System.hpp"
+
+enum class PlacementPolicy {
+	NONE,          // Leave placement to the OS scheduler
+	COMPACT,       // Consecutive logical CPUs in OS order
+	SCATTER,       // One thread per physical core, round-robin across packages, siblings last
+	SMT_SIBLINGS,  // Fill every hardware thread of a core before moving to the next core
+	LIST           // Explicit CPU list, reused cyclically when there are more threads than CPUs
+};
+
+#define DEFAULT_PLACEMENT_POLICY PlacementPolicy::NONE
+
+class ThreadPlacement {
+public:
+	/* Maps thread index -> logical CPU for the given policy, empty when threads are left unpinned */
+	static std::vector<int> BuildCpuMapping(PlacementPolicy policy, int numThreads,
+	                                        const std::vector<int>& cpuList = {});
+
+	/* Pins the calling thread to a single logical CPU, returns false if the OS refused */
+	static bool PinCurrentThread(int cpu);
+
+	/* "0;2;4;6" style rendering used in the report, "unpinned" for an empty mapping */
+	static std::string MappingToString(const std::vector<int>& mapping);
+
+	static std::string PlacementPolicyToString(PlacementPolicy policy);
+	static PlacementPolicy StringToPlacementPolicy(const std::string& policyStr);
+};
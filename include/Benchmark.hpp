@@ -4,43 +4,129 @@
 #include <vector>
 #include <fstream>
 #include <memory>
-#include <unordered_map>
 
+#include "Affinity.hpp"
 #include "BenchmarkTest.hpp"
+#include "Histogram.hpp"
+#include "Isa.hpp"
+#include "PerfCounters.hpp"
+#include "Scheduler.hpp"
+#include "Statistics.hpp"
 #include "System.hpp"
+#include "ThreadPool.hpp"
+#include "TestRegistry.hpp"
+#include "Tests.hpp"
+#include "Timer.hpp"
 
-// Helper function template to measure execution time of any function 
+// Helper function template to measure execution time of any function, Timer::Calibrate() must have run
 template<typename Func, typename... Args>
-std::chrono::milliseconds measureExecTime(Func&& func, Args&&... args) {
-	auto start = std::chrono::high_resolution_clock::now();
+TimingResult measureExecTime(Func&& func, Args&&... args) {
+	const Timer::Stamp start = Timer::Start();
 
 	if constexpr (std::is_void_v<std::invoke_result_t<Func, Args...>>)
 		std::forward<Func>(func)(std::forward<Args>(args)...);
 	else
 		[[maybe_unused]] auto result = std::forward<Func>(func)(std::forward<Args>(args)...);  // No use case of result for now
 
-	auto end = std::chrono::high_resolution_clock::now();
-	return std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+	const Timer::Stamp end = Timer::Stop();
+	return Timer::Elapsed(start, end);
 }
 
+#define MATRIX_SWEEP_MIN_SIZE 32
+#define MATRIX_SWEEP_MAX_SIZE 8192
+
+struct BenchmarkOptions {
+	int threads = BENCHMARK_THREAD_COUNT;
+	ScheduleMode schedule = DEFAULT_SCHEDULE_MODE;
+	int64_t chunkSize = DEFAULT_CHUNK_SIZE;
+	PlacementPolicy placement = DEFAULT_PLACEMENT_POLICY;
+	std::vector<int> cpuList;
+	int warmup = BENCHMARK_WARMUP_COUNT;
+	int repetitions = BENCHMARK_REPETITION_COUNT;
+	int64_t iterations = 0;             // Fixed iteration count for every test, 0 = calibrate or use the test default
+	int minTimeMs = BENCHMARK_MIN_TIME_MS;  // Calibration target per trial, 0 = no calibration
+	bool perfCounters = true;
+	bool scaling = false;               // Run the thread-scaling sweep instead of a single thread count
+	std::vector<int> scalingThreads;    // Thread counts for the sweep, empty = 1, 2, 4, ... up to the core count
+	bool latency = false;               // Time every iteration into per-thread latency histograms
+	std::vector<double> loadRates;      // Open-loop target rates in requests/s, empty = closed loop
+	ArrivalProcess arrival = DEFAULT_ARRIVAL_PROCESS;
+	int loadDurationMs = DEFAULT_LOAD_DURATION_MS;
+	bool hugePages = false;             // Back large matrix buffers with transparent huge pages
+	int matrixSize = DEFAULT_MATRIX_SIZE;
+	bool matrixSweep = false;           // Run the matrix size sweep with roofline reporting
+	std::vector<int> matrixSizes;       // Sizes for the sweep, empty = powers of two and their midpoints, 32 to 8192
+	int strassenCutoff = STRASSEN_DEFAULT_CUTOFF;  // Block size the Strassen recursion hands to the classical GEMM
+	int sparseSize = SPARSE_DEFAULT_SIZE;          // Rows and columns of the generated sparse matrix
+	double sparseDensity = SPARSE_DEFAULT_DENSITY; // Fraction of nonzero entries
+	SparsePattern sparsePattern = DEFAULT_SPARSE_PATTERN;
+	unsigned explicitTestParams = 0;    // TestParam flags of the test parameters the user set, tests pick their own defaults for the rest
+	SimdIsa isa = DEFAULT_SIMD_ISA;     // Kernel ISA, AUTO = widest supported by the CPU
+	uint64_t seed = DEFAULT_RANDOM_SEED;  // Seed of all test data and per-thread streams, 0 = fresh per run
+};
+
+/* Everything measured for one test at one thread count */
+struct TestMeasurement {
+	int64_t iterations = 0;
+	SampleStatistics stats;
+	double medianCycles = 0.0;
+	PerfCounterValues counters;
+	LatencyHistogram latency;  // Empty unless latency recording is enabled
+};
+
 class CPUBenchmark {
 private:
-	std::unordered_map<std::string, std::unique_ptr<BenchmarkTest>> m_TestsMap;
 	std::vector<std::unique_ptr<BenchmarkTest>> m_Tests;
+	std::unique_ptr<ThreadPool> m_Pool;
 	bool m_UseMultiThreading;
 	int m_ThreadCount;
-	int m_IterationCount;
+	int64_t m_IterationCount;
+	int m_MinTimeMs;
+	ScheduleMode m_ScheduleMode;
+	int64_t m_ChunkSize;
+	PlacementPolicy m_Placement;
+	std::vector<int> m_CpuMapping;  // Thread index -> logical CPU, empty when unpinned
+	int m_WarmupCount;
+	int m_RepetitionCount;
+	bool m_UsePerfCounters;
+	PerfCounters m_PerfCounters;
+	std::vector<int> m_ScalingThreads;  // Sorted, only set for the scaling sweep
+	bool m_RecordLatency;
+	std::vector<double> m_LoadRates;
+	ArrivalProcess m_Arrival;
+	int m_LoadDurationMs;
+	std::vector<int> m_MatrixSizes;  // Only set for the matrix size sweep
+	TestParams m_TestParams;
+	uint64_t m_Seed;
 	std::ofstream m_ReportFile;
 	SystemInfo m_SysInfo;
+	int m_VerificationFailures = 0;
 
 	void logSystemInfo();
-	void createTestsMap();
+	/* The TestMode flags a test must support for the options of this run */
+	unsigned requiredTestMode() const;
+	void configureTest(BenchmarkTest& test);
+	/* numThreads == 0 selects the single-threaded Run() path, anything else RunMultiThreaded(); events of the timed region are added to counters when given */
+	TimingResult runTrial(BenchmarkTest& test, int numThreads, PerfCounterValues* counters = nullptr);
+	void calibrateIterations(BenchmarkTest& test, int numThreads);
+	/* SetUp, calibration, warmup, the timed trials and Verify, then TearDown */
+	TestMeasurement measureTest(BenchmarkTest& test, int numThreads);
+	TestMeasurement measurePreparedTest(BenchmarkTest& test, int numThreads);
+	/* Counts a failed Verify before passing the exception on, so the run as a whole fails */
+	void verifyTest(BenchmarkTest& test);
 
 public:
-	CPUBenchmark(int threads = BENCHMARK_THREAD_COUNT);
+	CPUBenchmark(const BenchmarkOptions& options = BenchmarkOptions());
 	~CPUBenchmark();
 
 	void AddTest(std::unique_ptr<BenchmarkTest> test);
-	std::unique_ptr<BenchmarkTest> FindTest(const std::string& testname);
+	/* New instance of a registered test, nullptr if unknown or unable to run in this mode */
+	std::unique_ptr<BenchmarkTest> CreateTest(const std::string& testname);
 	void RunAllTests();
+	void RunScalingSweep();
+	void RunLoadSweep();
+	void RunMatrixSweep();
+
+	/* Tests whose results did not verify, none of their timings were reported */
+	int GetVerificationFailures() const;
 };
@@ -1,6 +1,13 @@
 #pragma once
 #include <string>
 #include <stdexcept>
+#include <vector>
+
+#include "Histogram.hpp"
+#include "LoadGenerator.hpp"
+#include "Random.hpp"
+#include "Scheduler.hpp"
+#include "ThreadPool.hpp"
 
 #ifndef BENCHMARK_ITERATION_COUNT
 #define BENCHMARK_ITERATION_COUNT 10'000'000
@@ -10,6 +17,22 @@
 #define BENCHMARK_THREAD_COUNT 4
 #endif
 
+#ifndef BENCHMARK_MAX_ITERATION_COUNT
+#define BENCHMARK_MAX_ITERATION_COUNT 1'000'000'000
+#endif
+
+#ifndef BENCHMARK_MIN_TIME_MS
+#define BENCHMARK_MIN_TIME_MS 500
+#endif
+
+#ifndef BENCHMARK_WARMUP_COUNT
+#define BENCHMARK_WARMUP_COUNT 1
+#endif
+
+#ifndef BENCHMARK_REPETITION_COUNT
+#define BENCHMARK_REPETITION_COUNT 5
+#endif
+
 using benchmark_float_type = double;
 
 class BenchmarkException : public std::runtime_error {
@@ -17,21 +40,164 @@ public:
 	BenchmarkException(const std::string& msg) : std::runtime_error(msg) {}
 };
 
+/* A kernel produced a wrong result; its timings must not be reported */
+class VerificationException : public BenchmarkException {
+public:
+	VerificationException(const std::string& msg) : BenchmarkException(msg) {}
+};
+
+enum class WorkUnit {
+	ITERATION,  // Nothing finer counted, scored in iterations/ms
+	FLOP,       // Floating point operations, scored in GFLOP/s
+	INT_OP,     // Integer arithmetic operations, scored in GOP/s
+	ITEM        // Domain items such as numbers tested, scored in Mitems/s
+};
+
+/* Work one iteration of a test does, the harness turns it into rates, ns/unit and cycles/unit */
+struct WorkPerIteration {
+	WorkUnit unit = WorkUnit::ITERATION;
+	double amount = 1.0;            // Units per iteration
+	double bytes = 0.0;             // Compulsory memory traffic, 0 when not counted
+	std::string itemName = "item";  // What one ITEM is, e.g. "number tested"
+
+	/* Name of one unit in the report */
+	std::string UnitName() const;
+	/* Rate the score is given in, and how many units per second one of it stands for */
+	std::string RateUnit() const;
+	double RateScale() const;
+};
+
+#define SETUP_RANDOM_STREAM 0  // Stream of the test seed SetUp draws its data from, worker t uses stream t + 1
+
+/* Per-thread state the harness hands to every iteration, owned by one worker for the length of a run */
+struct ThreadContext {
+	int threadIndex = 0;
+	Xoshiro256 random;
+};
+
 class BenchmarkTest {
 protected:
 	std::string m_Name;
 	benchmark_float_type m_Score = 0.0;
-	int m_IterationCount = BENCHMARK_ITERATION_COUNT;
+	int64_t m_IterationCount = BENCHMARK_ITERATION_COUNT;
+	ScheduleMode m_ScheduleMode = DEFAULT_SCHEDULE_MODE;
+	int64_t m_ChunkSize = DEFAULT_CHUNK_SIZE;
+	ThreadPool* m_Pool = nullptr;  // Owned by CPUBenchmark
+	bool m_RecordLatency = false;
+	std::vector<LatencyHistogram> m_LatencyHistograms;  // One per thread, only written by that thread
+	std::vector<ThreadContext> m_ThreadContexts;  // One per worker of the coming run, built before its timer starts
+	uint64_t m_Seed = DEFAULT_RANDOM_SEED;
+
+	/* Context of worker threadIndex, its random stream restarts at the same point on every run */
+	ThreadContext CreateThreadContext(int threadIndex) const;
+
+	/* Prepared context of worker threadIndex; only builds one on the spot when the harness did not prepare the run */
+	ThreadContext& GetThreadContext(int threadIndex);
+
+	/* Runs job on numThreads workers of the shared pool, or on a temporary pool when none is attached */
+	void RunOnThreads(int numThreads, const ThreadPool::Job& job);
+
+	/* Makes sure every thread of the coming run has its own histogram, keeps what was recorded so far */
+	void PrepareLatencyHistograms(int numThreads);
 
 public:
 	BenchmarkTest(const std::string& testName);
 	virtual ~BenchmarkTest() = default;
 
+	/*
+	 * Untimed lifecycle around the measured runs: SetUp allocates and initializes
+	 * whatever the kernel works on, ResetTrial runs before every trial to restore
+	 * state a trial consumes, Verify checks what the last trial produced against
+	 * a scalar reference or known answers and throws VerificationException on a
+	 * mismatch, TearDown releases the state again. Run, RunMultiThreaded and
+	 * RunSingleIteration only execute the kernel on that prepared state.
+	 */
+	virtual void SetUp();
+	virtual void ResetTrial();
+	/* Untimed, after SetUp and before RunOpenLoop: scratch for numThreads workers running RunSingleIteration concurrently */
+	virtual void SetUpOpenLoop(int numThreads);
+	virtual void Verify();
+	virtual void TearDown();
+
 	virtual void Run() = 0;
 	virtual void RunMultiThreaded(int numThreads);
-	virtual void RunSingleIteration() = 0;
+	virtual void RunSingleIteration(ThreadContext& context) = 0;
+
+	/* Iterations [begin, end) on one thread, one virtual call per chunk; falls back to RunSingleIteration */
+	virtual void RunIterations(int64_t begin, int64_t end, ThreadContext& context);
 
 	std::string GetName() const;
 	void SetScore(benchmark_float_type score);
 	benchmark_float_type GetScore() const;
-};
\ No newline at end of file
+	void SetSchedule(ScheduleMode mode, int64_t chunkSize);
+	void SetIterationCount(int64_t iterationCount);
+	int64_t GetIterationCount() const;
+	void SetThreadPool(ThreadPool* pool);
+
+	/* Fresh contexts for workers [0, numThreads) ahead of a timed run, so the stream jumps stay outside the timer */
+	void PrepareThreadContexts(int numThreads);
+
+	/* Seed of every random stream of the test, so a seeded run draws the same data and operands again */
+	void SetSeed(uint64_t seed);
+	uint64_t GetSeed() const;
+
+	/* One iteration of WorkUnit::ITERATION and no bytes unless overridden */
+	virtual WorkPerIteration GetWork() const;
+
+	/* |actual - expected| <= tolerance, NaN never matches */
+	static bool NearlyEqual(double actual, double expected, double tolerance);
+
+	/* Throws VerificationException naming the test and what was compared unless NearlyEqual */
+	void ExpectNear(const std::string& what, double actual, double expected, double tolerance) const;
+	void ExpectEqual(const std::string& what, int64_t actual, int64_t expected) const;
+
+	/* Per-iteration latency recording, timed with the same Timer as the trials */
+	void SetLatencyRecording(bool enabled);
+	bool IsLatencyRecording() const;
+	void ResetLatencyHistograms();
+	LatencyHistogram GetLatencyHistogram() const;  // All threads merged
+
+	/*
+	 * Open-loop load: totalRequests calls to RunSingleIteration spread over numThreads workers, each
+	 * dispatched at its intended arrival time for the target rate. Latency is measured from the intended
+	 * start into the latency histograms. Returns the wall time from the first arrival to the last completion.
+	 */
+	int64_t RunOpenLoop(int numThreads, double requestsPerSecond, ArrivalProcess arrival, int64_t totalRequests);
+};
+
+/* Keeps a result alive without forcing it through memory on every iteration */
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	volatile T sink = value;
+	(void)sink;
+#endif
+}
+
+/*
+ * CRTP base for tests with a tiny per-iteration body. Derived implements a
+ * non-virtual Iteration(ThreadContext&) returning a value; RunIterations calls
+ * it directly in a loop, so the body is inlined and the compiler can unroll
+ * it, and the results are folded together and kept alive once per batch
+ * instead of once per iteration. RunSingleIteration stays available for the
+ * per-iteration latency and open-loop paths.
+ */
+template<typename Derived>
+class BatchedTest : public BenchmarkTest {
+public:
+	using BenchmarkTest::BenchmarkTest;
+
+	void RunSingleIteration(ThreadContext& context) final {
+		DoNotOptimize(static_cast<Derived*>(this)->Iteration(context));
+	}
+
+	void RunIterations(int64_t begin, int64_t end, ThreadContext& context) final {
+		Derived& self = static_cast<Derived&>(*this);
+		decltype(self.Iteration(context)) result{};
+		for (int64_t iter = begin; iter < end; ++iter)
+			result += self.Iteration(context);
+		DoNotOptimize(result);
+	}
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Isa.hpp"
+#include "Matrix.hpp"
+#include "Precision.hpp"
+
+#define GEMM_MR 6        // Rows of the register tile, the same for every ISA
+#define GEMM_MAX_NR 32   // Widest register tile, AVX-512 FP32 uses two 16-float vectors
+#define GEMM_TILES_PER_THREAD 4  // Target number of C tiles per thread for the parallel product
+
+/*
+ * Element types the packed panels are stored in and how many consecutive K
+ * values the microkernel consumes as one group. Types without a native kernel
+ * are widened while packing; the dot-product instructions (BF16 pairs, INT8
+ * quads) need each group interleaved next to its neighbours in K.
+ */
+template<typename TA, typename TB, typename TC>
+struct GemmTraits {
+	using PackedA = TA;
+	using PackedB = TB;
+	static constexpr size_t K_GROUP = 1;
+};
+
+/* FP16 has no arithmetic on x86 outside AVX512-FP16, it is widened to FP32 while packing */
+template<>
+struct GemmTraits<Float16, Float16, float> {
+	using PackedA = float;
+	using PackedB = float;
+	static constexpr size_t K_GROUP = 1;
+};
+
+/* BF16 pairs feed VDPBF16PS, two products per FP32 lane */
+template<>
+struct GemmTraits<BFloat16, BFloat16, float> {
+	using PackedA = BFloat16;
+	using PackedB = BFloat16;
+	static constexpr size_t K_GROUP = 2;
+};
+
+/* Unsigned times signed bytes, four products per INT32 lane, the operand order of VPDPBUSD */
+template<>
+struct GemmTraits<uint8_t, int8_t, int32_t> {
+	using PackedA = uint8_t;
+	using PackedB = int8_t;
+	static constexpr size_t K_GROUP = 4;
+};
+
+/* C tile (ldc apart) = or += packed MR x groups panel of A times packed groups x NR panel of B */
+template<typename PA, typename PB, typename TC>
+using GemmMicroKernel = void (*)(size_t groups, const PA* packedA, const PB* packedB, TC* c, size_t ldc, bool accumulate);
+
+/* One microkernel variant, what it needs from the CPU and the register tile width its packed B panels use */
+template<typename PA, typename PB, typename TC>
+struct GemmKernel {
+	SimdIsa isa;
+	CpuFeature feature;
+	size_t nr;
+	GemmMicroKernel<PA, PB, TC> microKernel;
+	const char* name;
+};
+
+/* Cache block sizes of the packed GEMM, in elements */
+struct GemmBlocking {
+	size_t mc;  // Rows of A packed per block, sized to stay resident in L2
+	size_t kc;  // Shared dimension per block, sized so a kc x NR panel of B stays in L1
+	size_t nc;  // Columns of B packed per block, sized to stay resident in L3
+};
+
+/* Partition of C into a grid of tiles, each a whole number of register tiles except at the edges */
+struct GemmTiling {
+	size_t tileRows;
+	size_t tileCols;
+	size_t rowTiles;
+	size_t colTiles;
+
+	size_t Count() const { return rowTiles * colTiles; }
+};
+
+/*
+ * All of B packed once for a product whose C tiles are spread over threads,
+ * so the threads share one copy instead of each packing the panels of its
+ * own tiles. Every kc block of rows holds paddedCols / nr micro-panels in
+ * the layout PackB produces, block p starting at p * kc * paddedCols.
+ */
+template<typename PB>
+struct GemmPackedB {
+	Matrix<PB> storage;
+	size_t depth = 0;       // Rows of B
+	size_t cols = 0;        // Columns of B
+	size_t paddedCols = 0;  // Columns rounded up to whole micro-panels
+	size_t kc = 0;
+	size_t nr = 0;
+};
+
+/*
+ * BLIS-style GEMM, C = A * B with A of TA, B of TB and C of TC. B is packed
+ * into kc x nc blocks of NR-wide micro-panels and A into mc x kc blocks of
+ * MR-high micro-panels, both stored contiguously in the order the microkernel
+ * consumes them. The microkernel keeps a 6 x NR tile of C in registers; the
+ * packed panels are zero padded, so edge tiles run the same kernel into a
+ * scratch tile. The microkernel is the best one the active ISA from
+ * IsaDispatch and the detected CPU features allow, e.g. for FP32 scalar,
+ * SSE4.2 (6x16), AVX2+FMA (6x16) or AVX-512F (6x32).
+ */
+template<typename TA, typename TB, typename TC>
+class GemmEngine {
+public:
+	using PackedA = typename GemmTraits<TA, TB, TC>::PackedA;
+	using PackedB = typename GemmTraits<TA, TB, TC>::PackedB;
+	using Kernel = GemmKernel<PackedA, PackedB, TC>;
+	static constexpr size_t K_GROUP = GemmTraits<TA, TB, TC>::K_GROUP;
+
+	/* Microkernel for the active ISA */
+	static const Kernel& GetKernel();
+
+	/* Block sizes for the active kernel, derived from the detected L1/L2/L3 capacities */
+	static GemmBlocking GetBlocking();
+
+	/* C[rowBegin:rowEnd, :] = A[rowBegin:rowEnd, :] * B, running on the calling thread */
+	static void Multiply(MatrixView<const TA> a, MatrixView<const TB> b, MatrixView<TC> c,
+		size_t rowBegin, size_t rowEnd);
+
+	/* C[rowBegin:rowEnd, colBegin:colEnd] = A[rowBegin:rowEnd, :] * B[:, colBegin:colEnd] */
+	static void MultiplyTile(MatrixView<const TA> a, MatrixView<const TB> b, MatrixView<TC> c,
+		size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd);
+
+	/* Starts from one cache block per tile and halves the longer side until every thread gets several tiles */
+	static GemmTiling PlanTiles(size_t rows, size_t cols, int numThreads);
+	static void MultiplyTile(MatrixView<const TA> a, MatrixView<const TB> b, MatrixView<TC> c,
+		const GemmTiling& tiling, size_t tileIndex);
+
+	/* Grows the calling thread's packing buffers for products up to rows x depth times depth x cols, so timed runs do not allocate */
+	static void ReserveThreadBuffers(size_t rows, size_t depth, size_t cols);
+
+	/* Sizes packed for a depth x cols B and the active kernel; the storage only grows, so call it before timing */
+	static void PrepareB(size_t depth, size_t cols, GemmPackedB<PackedB>& packed);
+	/* Packs share part of parts of the micro-panels of every kc block, so a pool can pack B together */
+	static void PackSharedB(MatrixView<const TB> b, GemmPackedB<PackedB>& packed, size_t part, size_t parts);
+	/* Tile of C from B packed by PackSharedB, only packs A */
+	static void MultiplyTile(MatrixView<const TA> a, const GemmPackedB<PackedB>& b, MatrixView<TC> c,
+		const GemmTiling& tiling, size_t tileIndex);
+
+	static const char* GetKernelName();
+
+private:
+	static GemmBlocking ComputeBlocking(size_t nr);
+
+	/* Loop nest around the microkernel, panelsOfB(jc, nb, pc, kb) returns the packed kb x nb block of B at (pc, jc) */
+	template<typename PanelsOfB>
+	static void MultiplyBlocks(MatrixView<const TA> a, MatrixView<TC> c,
+		size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd, const PanelsOfB& panelsOfB);
+
+	static void PackA(MatrixView<const TA> a, size_t rowBegin, size_t rows, size_t kBegin, size_t depth, PackedA* packed);
+	static void PackB(MatrixView<const TB> b, size_t kBegin, size_t depth, size_t colBegin, size_t cols, size_t panelWidth, PackedB* packed);
+};
+
+/* Defined in Gemm.cpp for exactly these type combinations */
+extern template class GemmEngine<float, float, float>;
+extern template class GemmEngine<double, double, double>;
+extern template class GemmEngine<Float16, Float16, float>;
+extern template class GemmEngine<BFloat16, BFloat16, float>;
+extern template class GemmEngine<uint8_t, int8_t, int32_t>;
+
+using Gemm = GemmEngine<float, float, float>;
+using GemmFP64 = GemmEngine<double, double, double>;
+using GemmFP16 = GemmEngine<Float16, Float16, float>;
+using GemmBF16 = GemmEngine<BFloat16, BFloat16, float>;
+using GemmInt8 = GemmEngine<uint8_t, int8_t, int32_t>;
@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "System.hpp"
+
+#define HISTOGRAM_SUB_BUCKET_BITS 6  // 64 linear sub-buckets per power of two, relative error below 1/32
+
+/*
+ * HDR-style log-linear histogram of non-negative integer values (nanoseconds
+ * in practice). Values below 2^SUB_BUCKET_BITS are counted exactly, larger
+ * ones fall into one of 2^(SUB_BUCKET_BITS - 1) linear buckets per power of
+ * two. Each recording thread owns its own instance, so Record() needs no
+ * atomics or locks; instances are merged once the threads have joined.
+ * The counts are stored inline and the object is cache-line aligned (its
+ * size is a whole number of lines), so neighbouring per-thread instances in
+ * a vector never share a cache line.
+ */
+class alignas(CACHE_LINE_SIZE) LatencyHistogram {
+public:
+	LatencyHistogram();
+
+	inline void Record(int64_t value) {
+		const uint64_t v = value > 0 ? static_cast<uint64_t>(value) : 0;
+		++m_Counts[BucketIndex(v)];
+		++m_TotalCount;
+		m_Min = std::min(m_Min, v);
+		m_Max = std::max(m_Max, v);
+	}
+
+	void Merge(const LatencyHistogram& other);
+	void Reset();
+
+	uint64_t GetCount() const;
+	uint64_t GetMin() const;
+	uint64_t GetMax() const;
+
+	/* Upper bound of the bucket holding the given percentile (0-100), exact max for 100 */
+	uint64_t GetValueAtPercentile(double percentile) const;
+
+private:
+	static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << HISTOGRAM_SUB_BUCKET_BITS;
+	static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+	static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (64 - HISTOGRAM_SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+	std::array<uint64_t, BUCKET_COUNT> m_Counts;
+	uint64_t m_TotalCount = 0;
+	uint64_t m_Min;
+	uint64_t m_Max = 0;
+
+	static inline size_t BucketIndex(uint64_t value) {
+		if (value < SUB_BUCKET_COUNT)
+			return static_cast<size_t>(value);
+
+#if defined(__GNUC__)
+		const int msb = 63 - __builtin_clzll(value);
+#else
+		int msb = 63;
+		while (!(value >> msb))
+			--msb;
+#endif
+		const int shift = msb - HISTOGRAM_SUB_BUCKET_BITS + 1;
+		const uint64_t sub = value >> shift;  // In [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+		return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + (sub - SUB_BUCKET_HALF));
+	}
+
+	static uint64_t BucketUpperBound(size_t index);
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <string>
+
+/*
+ * Kernels for wider instruction sets are compiled with per-function target
+ * attributes instead of global -m flags, so one binary carries every variant
+ * and IsaDispatch picks the widest one the CPU and OS actually support.
+ */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	#include <immintrin.h>
+	#define BENCHMARK_X86 1
+	#define TARGET_SSE42 __attribute__((target("sse4.2")))
+	#define TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+	#define TARGET_AVX512F __attribute__((target("avx512f")))
+	#define TARGET_F16C __attribute__((target("avx,f16c")))
+	#define TARGET_AVX_VNNI __attribute__((target("avx2,avxvnni")))
+	#define TARGET_AVX512_VNNI __attribute__((target("avx512f,avx512vnni")))
+	#define TARGET_AVX512_BF16 __attribute__((target("avx512f,avx512bf16")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <immintrin.h>
+	#define BENCHMARK_X86 1
+	#define TARGET_SSE42
+	#define TARGET_AVX2_FMA
+	#define TARGET_AVX512F
+	#define TARGET_F16C
+	#define TARGET_AVX_VNNI
+	#define TARGET_AVX512_VNNI
+	#define TARGET_AVX512_BF16
+#else
+	#define BENCHMARK_X86 0
+#endif
+
+enum class SimdIsa {
+	AUTO,      // Widest supported, only meaningful as a request
+	SCALAR,
+	SSE42,
+	AVX2_FMA,
+	AVX512F
+};
+
+#define DEFAULT_SIMD_ISA SimdIsa::AUTO
+
+/* Extensions some kernels need on top of their base ISA */
+enum class CpuFeature {
+	NONE,
+	F16C,         // Half precision conversion
+	AVX_VNNI,     // VEX encoded u8 x s8 dot products
+	AVX512_VNNI,
+	AVX512_BF16   // BF16 pair dot products
+};
+
+class IsaDispatch {
+public:
+	/* Checks both the CPUID feature bits and that the OS saves the matching register state */
+	static bool IsSupported(SimdIsa isa);
+	static SimdIsa GetBestSupported();
+	static bool HasFeature(CpuFeature feature);
+
+	/* Makes the requested ISA active, AUTO or an unsupported request falls back to the best supported one */
+	static SimdIsa Select(SimdIsa requested);
+	static SimdIsa GetActive();
+
+	static std::string IsaToString(SimdIsa isa);
+	static SimdIsa StringToIsa(const std::string& isaStr);
+	static std::string FeatureToString(CpuFeature feature);
+
+private:
+	static std::atomic<SimdIsa> s_Active;
+};
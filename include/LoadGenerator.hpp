@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "Random.hpp"
+
+enum class ArrivalProcess {
+	CONSTANT,  // Evenly spaced arrivals
+	POISSON    // Exponentially distributed gaps with the same mean rate
+};
+
+#define DEFAULT_ARRIVAL_PROCESS ArrivalProcess::CONSTANT
+#define DEFAULT_LOAD_DURATION_MS 1000
+#define LOAD_SPIN_THRESHOLD_NS 50'000  // Sleep until this close to an arrival, then spin
+#define OPEN_LOOP_START_DELAY_NS 1'000'000
+#define OPEN_LOOP_SEED 0x9E3779B97F4A7C15ull  // Mixed into the run seed, so arrival streams are separate from the test's streams
+
+/*
+ * Intended start times of one load-generating thread. Times are absolute
+ * steady-clock nanoseconds and never depend on when earlier requests
+ * actually finished, so a request that starts late because the previous
+ * one ran long is charged for the wait (coordinated-omission correction).
+ */
+class ArrivalSchedule {
+public:
+	/* Poisson gaps are drawn from random, so one stream of the run seed reproduces the same arrivals */
+	ArrivalSchedule(ArrivalProcess process, double requestsPerSecond, int64_t startNs, Xoshiro256 random);
+
+	/* Intended start of the next request */
+	int64_t Next();
+
+	/* Blocks until the given steady-clock time, sleeping first and spinning for the last stretch */
+	static void WaitUntil(int64_t targetNs);
+
+	static std::string ArrivalProcessToString(ArrivalProcess process);
+	static ArrivalProcess StringToArrivalProcess(const std::string& processStr);
+
+private:
+	ArrivalProcess m_Process;
+	double m_IntervalNs;
+	double m_NextNs;
+	Xoshiro256 m_Random;
+	std::exponential_distribution<double> m_Gap;
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "System.hpp"
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/*
+ * Cache-line aligned raw storage for dense kernels. With huge pages enabled,
+ * allocations of at least HUGE_PAGE_SIZE are aligned to that size and advised
+ * for transparent huge pages, which cuts dTLB misses on large operands.
+ */
+class AlignedAllocator {
+public:
+	static void* Allocate(size_t bytes);
+	static void Free(void* ptr);
+
+	static void SetHugePages(bool enabled);
+	static bool UsesHugePages();
+
+private:
+	static bool s_HugePages;
+};
+
+/*
+ * Non-owning window onto row-major storage: a whole Matrix or a block of one.
+ * Kernels take views so that recursive algorithms can hand them quadrants
+ * without copying. A view of T converts to a view of const T.
+ * A view promises no alignment: a block at an arbitrary column, or a view
+ * over foreign storage, starts anywhere. Kernels therefore read and write
+ * view rows with unaligned loads and stores; aligned loads are only used on
+ * buffers the kernel packed itself.
+ */
+template<typename T>
+class MatrixView {
+public:
+	MatrixView() = default;
+
+	MatrixView(T* data, size_t rows, size_t cols, size_t leadingDimension)
+		: m_Data(data), m_Rows(rows), m_Cols(cols), m_LeadingDimension(leadingDimension) {}
+
+	template<typename U, typename = std::enable_if_t<std::is_same<const U, T>::value>>
+	MatrixView(const MatrixView<U>& other)
+		: m_Data(other.Data()), m_Rows(other.Rows()), m_Cols(other.Cols()), m_LeadingDimension(other.LeadingDimension()) {}
+
+	size_t Rows() const { return m_Rows; }
+	size_t Cols() const { return m_Cols; }
+	size_t LeadingDimension() const { return m_LeadingDimension; }
+
+	T* Data() const { return m_Data; }
+	T* Row(size_t i) const { return m_Data + i * m_LeadingDimension; }
+	T& operator()(size_t i, size_t j) const { return m_Data[i * m_LeadingDimension + j]; }
+
+	/* rows x cols block starting at (row, col) */
+	MatrixView Block(size_t row, size_t col, size_t rows, size_t cols) const {
+		return MatrixView(m_Data + row * m_LeadingDimension + col, rows, cols, m_LeadingDimension);
+	}
+
+private:
+	T* m_Data = nullptr;
+	size_t m_Rows = 0;
+	size_t m_Cols = 0;
+	size_t m_LeadingDimension = 0;
+};
+
+/*
+ * Dense row-major matrix in one contiguous block. Rows are padded to the
+ * leading dimension, which is at least the column count and always rounded
+ * up to a whole cache line, so every row starts on a CACHE_LINE_SIZE
+ * boundary and aligned vector loads are valid at multiples of the vector
+ * width.
+ */
+template<typename T>
+class Matrix {
+public:
+	Matrix() = default;
+
+	Matrix(size_t rows, size_t cols, size_t leadingDimension = 0)
+		: m_Rows(rows), m_Cols(cols), m_LeadingDimension(PaddedColumns(std::max(leadingDimension, cols)))
+	{
+		if (m_Rows * m_LeadingDimension > 0) {
+			m_Data = static_cast<T*>(AlignedAllocator::Allocate(m_Rows * m_LeadingDimension * sizeof(T)));
+			std::memset(m_Data, 0, m_Rows * m_LeadingDimension * sizeof(T));
+		}
+	}
+
+	~Matrix() {
+		AlignedAllocator::Free(m_Data);
+	}
+
+	Matrix(const Matrix&) = delete;
+	Matrix& operator=(const Matrix&) = delete;
+
+	Matrix(Matrix&& other) noexcept { Swap(other); }
+	Matrix& operator=(Matrix&& other) noexcept {
+		Matrix(std::move(other)).Swap(*this);
+		return *this;
+	}
+
+	size_t Rows() const { return m_Rows; }
+	size_t Cols() const { return m_Cols; }
+	size_t LeadingDimension() const { return m_LeadingDimension; }
+
+	T* Data() { return m_Data; }
+	const T* Data() const { return m_Data; }
+
+	T* Row(size_t i) { return m_Data + i * m_LeadingDimension; }
+	const T* Row(size_t i) const { return m_Data + i * m_LeadingDimension; }
+
+	T& operator()(size_t i, size_t j) { return m_Data[i * m_LeadingDimension + j]; }
+	const T& operator()(size_t i, size_t j) const { return m_Data[i * m_LeadingDimension + j]; }
+
+	operator MatrixView<T>() { return MatrixView<T>(m_Data, m_Rows, m_Cols, m_LeadingDimension); }
+	operator MatrixView<const T>() const { return MatrixView<const T>(m_Data, m_Rows, m_Cols, m_LeadingDimension); }
+
+	/* Columns a row has to be padded to so that the next row starts on a new cache line */
+	static size_t PaddedColumns(size_t cols) {
+		const size_t perLine = std::max<size_t>(1, CACHE_LINE_SIZE / sizeof(T));
+		return (cols + perLine - 1) / perLine * perLine;
+	}
+
+private:
+	T* m_Data = nullptr;
+	size_t m_Rows = 0;
+	size_t m_Cols = 0;
+	size_t m_LeadingDimension = 0;
+
+	void Swap(Matrix& other) noexcept {
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Rows, other.m_Rows);
+		std::swap(m_Cols, other.m_Cols);
+		std::swap(m_LeadingDimension, other.m_LeadingDimension);
+	}
+};
@@ -9,8 +9,15 @@ using json = nlohmann::json;
 /* Command line parsing */
 #include <CLI11/CLI11.hpp>
 
+#include "Affinity.hpp"
 #include "BenchmarkTest.hpp"
+#include "Isa.hpp"
+#include "LoadGenerator.hpp"
 #include "Logger.hpp"
+#include "Plugin.hpp"
+#include "Scheduler.hpp"
+#include "TestRegistry.hpp"
+#include "Tests.hpp"
 
 class ConfigParser {
 public:
@@ -20,6 +27,32 @@ public:
     int threads() const;
     std::string output_file() const;
     std::string log_level() const;
+    std::string schedule() const;
+    int64_t chunk_size() const;
+    std::string affinity() const;
+    std::vector<int> cpu_list() const;
+    int warmup() const;
+    int repetitions() const;
+    int64_t iterations() const;
+    int min_time_ms() const;
+    bool perf_counters() const;
+    bool scaling() const;
+    std::vector<int> scaling_threads() const;
+    bool latency() const;
+    std::vector<double> load_rates() const;
+    std::string arrival() const;
+    int load_duration_ms() const;
+    bool huge_pages() const;
+    int matrix_size() const;
+    bool matrix_sweep() const;
+    std::vector<int> matrix_sizes() const;
+    int strassen_cutoff() const;
+    int sparse_size() const;
+    double sparse_density() const;
+    std::string sparse_pattern() const;
+    std::string isa() const;
+    uint64_t seed() const;
+    std::string plugin_dir() const;
     void validate() const;
 
     std::vector<std::string> GetTestNames() const;
@@ -40,6 +73,35 @@ public:
     int threads() const;
     std::string output_file() const;
     std::string log_level() const;
+    ScheduleMode schedule() const;
+    int64_t chunk_size() const;
+    PlacementPolicy affinity() const;
+    std::vector<int> cpu_list() const;
+    int warmup() const;
+    int repetitions() const;
+    int64_t iterations() const;
+    int min_time_ms() const;
+    bool perf_counters() const;
+    bool scaling() const;
+    std::vector<int> scaling_threads() const;
+    bool latency() const;
+    std::vector<double> load_rates() const;
+    ArrivalProcess arrival() const;
+    int load_duration_ms() const;
+    bool huge_pages() const;
+    int matrix_size() const;
+    bool matrix_sweep() const;
+    std::vector<int> matrix_sizes() const;
+    int strassen_cutoff() const;
+    int sparse_size() const;
+    double sparse_density() const;
+    SparsePattern sparse_pattern() const;
+    /* TestParam flags of the test parameters given on the command line or changed in the config file */
+    unsigned explicit_test_params() const;
+    SimdIsa isa() const;
+    uint64_t seed() const;
+    std::string plugin_dir() const;
+    bool list_tests() const;
     std::vector<std::string> GetTestNames() const;
 
 private:
@@ -48,5 +110,33 @@ private:
     int m_Threads = BENCHMARK_THREAD_COUNT;
     std::string m_OutputFile = DEFAULT_FILENAME;
     std::string m_LogLevel = "INFO";
+    std::string m_Schedule = WorkScheduler::ScheduleModeToString(DEFAULT_SCHEDULE_MODE);
+    int64_t m_ChunkSize = DEFAULT_CHUNK_SIZE;
+    std::string m_Affinity = ThreadPlacement::PlacementPolicyToString(DEFAULT_PLACEMENT_POLICY);
+    std::vector<int> m_CpuList;
+    int m_Warmup = BENCHMARK_WARMUP_COUNT;
+    int m_Repetitions = BENCHMARK_REPETITION_COUNT;
+    int64_t m_Iterations = 0;
+    int m_MinTimeMs = BENCHMARK_MIN_TIME_MS;
+    bool m_PerfCounters = true;
+    bool m_Scaling = false;
+    std::vector<int> m_ScalingThreads;
+    bool m_Latency = false;
+    std::vector<double> m_LoadRates;
+    std::string m_Arrival = ArrivalSchedule::ArrivalProcessToString(DEFAULT_ARRIVAL_PROCESS);
+    int m_LoadDurationMs = DEFAULT_LOAD_DURATION_MS;
+    bool m_HugePages = false;
+    int m_MatrixSize = DEFAULT_MATRIX_SIZE;
+    bool m_MatrixSweep = false;
+    std::vector<int> m_MatrixSizes;
+    int m_StrassenCutoff = STRASSEN_DEFAULT_CUTOFF;
+    int m_SparseSize = SPARSE_DEFAULT_SIZE;
+    double m_SparseDensity = SPARSE_DEFAULT_DENSITY;
+    std::string m_SparsePattern = SparseGenerator::PatternToString(DEFAULT_SPARSE_PATTERN);
+    unsigned m_ExplicitTestParams = 0;
+    std::string m_Isa = IsaDispatch::IsaToString(DEFAULT_SIMD_ISA);
+    uint64_t m_Seed = DEFAULT_RANDOM_SEED;
+    std::string m_PluginDir = DEFAULT_PLUGIN_DIR;
+    bool m_ListTests = false;
     std::vector<std::string> m_TestNames;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class PerfEvent {
+	CYCLES,
+	INSTRUCTIONS,
+	BRANCH_MISSES,
+	L1D_MISSES,
+	LLC_MISSES,
+	DTLB_MISSES,
+	COUNT
+};
+
+constexpr size_t PERF_EVENT_COUNT = static_cast<size_t>(PerfEvent::COUNT);
+
+/* Counter totals of one or more measured regions, summed over every monitored thread */
+struct PerfCounterValues {
+	std::array<uint64_t, PERF_EVENT_COUNT> values{};
+	std::array<bool, PERF_EVENT_COUNT> available{};
+
+	uint64_t Get(PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+	bool Has(PerfEvent event) const { return available[static_cast<size_t>(event)]; }
+
+	double Ipc() const;
+	double MissesPerKiloInstruction(PerfEvent event) const;  // Negative when either counter is missing
+
+	PerfCounterValues& operator+=(const PerfCounterValues& other);
+};
+
+/*
+ * perf_event_open based counters for a set of threads. Each thread gets its
+ * own event group (cycles as leader), since the persistent pool workers
+ * already exist and would not be picked up by inheritance. The calling
+ * thread's group is opened with inherit so threads spawned during a trial,
+ * e.g. a temporary fallback pool, are still counted. Events the kernel or
+ * PMU refuses are skipped individually; when not even cycles can be opened
+ * the counters report themselves unavailable and every call is a no-op.
+ */
+class PerfCounters {
+public:
+	PerfCounters() = default;
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/* Opens one group for the calling thread plus one per extra thread id, returns IsAvailable() */
+	bool Open(const std::vector<int64_t>& threadIds = {});
+	void Close();
+
+	void Start();
+	PerfCounterValues Stop();
+
+	bool IsAvailable() const;
+	std::string GetError() const;
+
+	static std::string EventToString(PerfEvent event);
+
+private:
+	struct Group {
+		std::array<int, PERF_EVENT_COUNT> fds;
+	};
+
+	std::vector<Group> m_Groups;
+	std::string m_Error;
+
+	bool OpenGroup(int64_t threadId, bool inherit);
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "BenchmarkTest.hpp"
+
+/*
+ * Interface of loadable test plugins. A plugin is a shared library exporting
+ * BENCHMARK_PLUGIN_ENTRY with C linkage; the loader calls it once and
+ * registers every test it describes next to the built-in ones.
+ *
+ * The tables and parameters are plain C, but create() hands a BenchmarkTest
+ * across the boundary. Plugins must therefore be built with the same
+ * compiler and the same headers as the executable, and they resolve
+ * BenchmarkTest, the logger and the other harness symbols from it (the
+ * executable is linked with -rdynamic). Bump BENCHMARK_PLUGIN_ABI_VERSION
+ * whenever these structs or the BenchmarkTest class layout change; plugins
+ * built for another version are refused.
+ */
+
+#define BENCHMARK_PLUGIN_ABI_VERSION 4
+#define BENCHMARK_PLUGIN_ENTRY "BenchmarkPluginGetInfo"
+#define DEFAULT_PLUGIN_DIR "plugins"
+
+#if defined(__GNUC__)
+#define BENCHMARK_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#else
+#define BENCHMARK_PLUGIN_EXPORT extern "C"
+#endif
+
+extern "C" {
+
+/* TestParams of the run, see TestRegistry.hpp */
+struct BenchmarkPluginParams {
+	uint64_t matrixSize;
+	uint64_t strassenCutoff;
+	uint64_t sparseSize;
+	double sparseDensity;
+	int32_t sparsePattern;  // SparsePattern value
+};
+
+struct BenchmarkPluginTest {
+	const char* name;         // Unique across the built-in and all loaded tests
+	const char* category;     // "gemm", "sparse" or "scalar"
+	unsigned modes;           // TestMode flags
+	const char* description;
+
+	/* New heap-allocated test, released with delete by the harness; returns nullptr instead of throwing */
+	BenchmarkTest* (*create)(const BenchmarkPluginParams* params);
+};
+
+struct BenchmarkPluginInfo {
+	uint32_t abiVersion;  // BENCHMARK_PLUGIN_ABI_VERSION the plugin was built against
+	const char* name;
+	size_t testCount;
+	const BenchmarkPluginTest* tests;
+};
+
+/* Type of BENCHMARK_PLUGIN_ENTRY, the returned table must stay valid while the library is loaded */
+typedef const BenchmarkPluginInfo* (*BenchmarkPluginEntry)(void);
+
+}
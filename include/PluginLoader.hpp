@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+
+#include "Plugin.hpp"
+#include "TestRegistry.hpp"
+
+/*
+ * Loads test plugins with dlopen and registers their tests in TestRegistry.
+ * Libraries stay loaded until the process exits, since the registered
+ * factories and every test they create live in them. A plugin that fails to
+ * load, has the wrong ABI version or names a test that already exists is
+ * skipped with a warning; the run goes on without it.
+ */
+class PluginLoader {
+public:
+	/* Loads every *.so file of the directory in name order, returns the number of tests registered */
+	static int LoadDirectory(const std::string& directory);
+
+	/* Returns the number of tests registered from this library */
+	static int Load(const std::string& path);
+
+private:
+	static BenchmarkPluginParams ToPluginParams(const TestParams& params);
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/*
+ * 16-bit floating point storage types. Both are plain bit containers; arithmetic
+ * happens in float after conversion, which is what the GEMM kernels do too.
+ */
+struct Float16 {
+	uint16_t bits;
+};
+
+struct BFloat16 {
+	uint16_t bits;
+};
+
+inline uint32_t FloatToBits(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+inline float BitsToFloat(uint32_t bits) {
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+/* BF16 is the upper half of a float, so widening is a shift */
+inline float ToFloat(BFloat16 value) {
+	return BitsToFloat(static_cast<uint32_t>(value.bits) << 16);
+}
+
+inline BFloat16 ToBFloat16(float value) {
+	const uint32_t bits = FloatToBits(value);
+	if ((bits & 0x7fffffff) > 0x7f800000)
+		return BFloat16{ static_cast<uint16_t>((bits >> 16) | 0x40) };  // Keep NaN a quiet NaN
+
+	/* Round to nearest, ties to even */
+	const uint32_t rounding = 0x7fff + ((bits >> 16) & 1);
+	return BFloat16{ static_cast<uint16_t>((bits + rounding) >> 16) };
+}
+
+inline float ToFloat(Float16 value) {
+	const uint32_t sign = static_cast<uint32_t>(value.bits & 0x8000) << 16;
+	uint32_t exponent = (value.bits >> 10) & 0x1f;
+	uint32_t mantissa = value.bits & 0x3ff;
+
+	if (exponent == 0x1f)
+		return BitsToFloat(sign | 0x7f800000 | (mantissa << 13));  // Inf or NaN
+	if (exponent == 0) {
+		if (mantissa == 0)
+			return BitsToFloat(sign);
+		/* Subnormal half, normalize it for the wider exponent range */
+		exponent = 1;
+		while (!(mantissa & 0x400)) {
+			mantissa <<= 1;
+			--exponent;
+		}
+		mantissa &= 0x3ff;
+	}
+	return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+inline Float16 ToFloat16(float value) {
+	const uint32_t bits = FloatToBits(value);
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	if (((bits >> 23) & 0xff) == 0xff)
+		return Float16{ static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0)) };
+	if (exponent >= 0x1f)
+		return Float16{ static_cast<uint16_t>(sign | 0x7c00) };  // Overflow to infinity
+	if (exponent <= 0) {
+		if (exponent < -10)
+			return Float16{ sign };  // Underflow to zero
+		/* Subnormal result, shift the implicit one into the mantissa */
+		mantissa |= 0x800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		const uint32_t rounded = (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+		return Float16{ static_cast<uint16_t>(sign | rounded) };
+	}
+
+	/* Round to nearest, ties to even; a carry out of the mantissa correctly bumps the exponent */
+	const uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	const uint32_t rest = mantissa & 0x1fff;
+	const uint32_t rounded = half + ((rest > 0x1000 || (rest == 0x1000 && (half & 1))) ? 1 : 0);
+	return Float16{ static_cast<uint16_t>(sign | rounded) };
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+#define DEFAULT_RANDOM_SEED 0  // 0 = draw a fresh seed for every run and log it
+
+/*
+ * xoshiro256** generator (Blackman and Vigna). The 256-bit state is expanded
+ * from the seed with SplitMix64, and Jump() advances it by 2^128 steps, so
+ * the streams of one seed never overlap. It is a UniformRandomBitGenerator,
+ * usable with the standard distributions. Not thread safe: every thread owns
+ * its own stream.
+ */
+class Xoshiro256 {
+public:
+	using result_type = uint64_t;
+
+	explicit Xoshiro256(uint64_t seed = 0);
+
+	/* Stream index of the given seed, the same pair always yields the same sequence */
+	static Xoshiro256 Stream(uint64_t seed, uint64_t index);
+
+	/* Seed for DEFAULT_RANDOM_SEED, from std::random_device */
+	static uint64_t RandomSeed();
+
+	inline uint64_t Next() {
+		const uint64_t result = Rotl(m_State[1] * 5, 7) * 9;
+		const uint64_t t = m_State[1] << 17;
+		m_State[2] ^= m_State[0];
+		m_State[3] ^= m_State[1];
+		m_State[1] ^= m_State[2];
+		m_State[0] ^= m_State[3];
+		m_State[2] ^= t;
+		m_State[3] = Rotl(m_State[3], 45);
+		return result;
+	}
+
+	/* Uniform in [0, bound), multiply-shift on the upper 32 bits */
+	inline uint32_t NextBelow(uint32_t bound) {
+		return static_cast<uint32_t>(((Next() >> 32) * bound) >> 32);
+	}
+
+	/* Uniform in [0, 1) with 53 random bits */
+	inline double NextDouble() {
+		return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+	}
+
+	void Jump();
+
+	inline uint64_t operator()() { return Next(); }
+	static constexpr uint64_t min() { return 0; }
+	static constexpr uint64_t max() { return std::numeric_limits<uint64_t>::max(); }
+
+private:
+	uint64_t m_State[4];
+
+	static inline uint64_t Rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+#include "ThreadPool.hpp"
+
+#define ROOFLINE_FMA_ITERATIONS 20'000'000              // FMA loop trips per thread for the peak measurement
+#define ROOFLINE_STREAM_MIN_BYTES (64 * 1024 * 1024)    // Per triad array, at least this large
+#define ROOFLINE_STREAM_MAX_BYTES (256 * 1024 * 1024)   // and at most this large
+#define ROOFLINE_TRIALS 3                               // Best of this many runs is kept
+
+/* Machine ceilings of the roofline model */
+struct RooflineCeilings {
+	double peakGflops = 0.0;      // Single precision FMA throughput
+	double bandwidthGBs = 0.0;    // STREAM triad bandwidth from memory
+
+	/* Arithmetic intensity (FLOP/byte) where the memory roof meets the compute roof */
+	double RidgePoint() const;
+	/* min(peak, intensity * bandwidth) */
+	double AttainableGflops(double intensity) const;
+};
+
+/*
+ * Measures the two roofs empirically on the threads the benchmark itself uses.
+ * Peak FLOPs come from independent FMA chains that never touch memory, bandwidth
+ * from a STREAM triad over arrays sized well past the last level cache.
+ */
+class Roofline {
+public:
+	static RooflineCeilings Measure(ThreadPool* pool, int numThreads);
+
+	static double MeasurePeakGflops(ThreadPool* pool, int numThreads);
+	static double MeasureTriadBandwidth(ThreadPool* pool, int numThreads);
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "System.hpp"
+
+enum class ScheduleMode {
+	STATIC,   // One contiguous range per thread, claimed once
+	DYNAMIC,  // Fixed-size chunks claimed from a shared counter
+	GUIDED,   // Chunks shrink with the remaining work, never below the chunk size
+	STEALING  // Per-thread contiguous ranges, idle threads steal half of a victim's remainder
+};
+
+#define DEFAULT_SCHEDULE_MODE ScheduleMode::DYNAMIC
+#define DEFAULT_CHUNK_SIZE 0  // 0 = derive the chunk size from the iteration and thread count
+#define CHUNKS_PER_THREAD 64  // Target number of dynamic chunks each thread claims
+
+/*
+ * Hands out iteration ranges [begin, end) to worker threads so that the
+ * shared counter is touched once per chunk instead of once per iteration.
+ */
+class WorkScheduler {
+public:
+	WorkScheduler(ScheduleMode mode, int64_t totalIterations, int numThreads, int64_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+	/* Claims the next range for the given thread, returns false once the work is exhausted */
+	bool NextChunk(int threadIndex, int64_t& begin, int64_t& end);
+
+	int64_t GetChunkSize() const;
+
+	static std::string ScheduleModeToString(ScheduleMode mode);
+	static ScheduleMode StringToScheduleMode(const std::string& modeStr);
+
+private:
+	/*
+	 * Each thread owns one of these, padded so that neighbours never share a cache line.
+	 * In stealing mode the range acts as the thread's deque: the owner takes chunks from
+	 * the front and thieves split off the back, both under the range's lock.
+	 */
+	struct alignas(CACHE_LINE_SIZE) ThreadRange {
+		int64_t begin = 0;
+		int64_t end = 0;
+		bool claimed = false;
+		std::mutex lock;
+	};
+
+	ScheduleMode m_Mode;
+	int64_t m_TotalIterations;
+	int m_NumThreads;
+	int64_t m_ChunkSize;
+	std::vector<ThreadRange> m_Ranges;
+	alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_Next{ 0 };
+
+	bool NextStaticChunk(int threadIndex, int64_t& begin, int64_t& end);
+	bool NextDynamicChunk(int64_t& begin, int64_t& end);
+	bool NextGuidedChunk(int64_t& begin, int64_t& end);
+	bool NextStealingChunk(int threadIndex, int64_t& begin, int64_t& end);
+	bool TakeFront(ThreadRange& range, int64_t& begin, int64_t& end);
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Matrix.hpp"
+
+#define SPARSE_DEFAULT_SIZE 262144     // Rows and columns of the generated matrix, large enough to stream from memory
+#define SPARSE_DEFAULT_DENSITY 5e-5    // Fraction of nonzero entries, about 13 per row at the default size
+#define SPARSE_SPMM_COLUMNS 16         // Columns of the dense operand in the SpMM tests
+#define SELL_CHUNK_HEIGHT 8            // Rows per SELL slice, one AVX2 register of floats
+#define SELL_DEFAULT_SIGMA 256         // Rows are sorted by length within windows of this many rows
+#define POWER_LAW_EXPONENT 1.0         // Row length of the row with rank r is proportional to r^-exponent
+
+enum class SparsePattern {
+	BANDED,     // Contiguous band around the diagonal
+	POWER_LAW,  // Few very long rows and a long tail of short ones, like web and social graphs
+	RANDOM      // Uniformly scattered, Poisson distributed row lengths
+};
+
+#define DEFAULT_SPARSE_PATTERN SparsePattern::RANDOM
+
+enum class SparseFormat {
+	CSR,
+	SELL
+};
+
+/* Compressed sparse rows, column indices sorted within each row */
+struct CsrMatrix {
+	size_t rows = 0;
+	size_t cols = 0;
+	std::vector<int64_t> rowOffsets;  // rows + 1 entries into columns and values
+	std::vector<int32_t> columns;
+	std::vector<float> values;
+
+	size_t Nonzeros() const { return values.size(); }
+};
+
+/*
+ * SELL-C-sigma: rows sorted by length within windows of sigma rows, then cut
+ * into slices of C rows. Each slice is padded to its longest row and stored
+ * column-major, so one vector load picks up element j of C consecutive rows.
+ * Padding entries have value 0 and column 0.
+ */
+struct SellMatrix {
+	size_t rows = 0;
+	size_t cols = 0;
+	size_t sigma = 0;
+	size_t nonzeros = 0;              // Without the padding
+	std::vector<int64_t> sliceOffsets;  // Slices + 1 entries into columns and values
+	std::vector<int32_t> rowOrder;    // Original row of each sorted position
+	std::vector<int32_t> columns;
+	std::vector<float> values;
+
+	size_t Slices() const { return sliceOffsets.empty() ? 0 : sliceOffsets.size() - 1; }
+	size_t StoredEntries() const { return values.size(); }
+
+	static SellMatrix FromCsr(const CsrMatrix& csr, size_t sigma = SELL_DEFAULT_SIGMA);
+};
+
+class SparseGenerator {
+public:
+	/* size x size matrix with about density * size^2 nonzeros in the given pattern, values uniform in [-1, 1) */
+	static CsrMatrix Generate(SparsePattern pattern, size_t size, double density, uint64_t seed);
+
+	static std::string PatternToString(SparsePattern pattern);
+	static SparsePattern StringToPattern(const std::string& patternStr);
+};
+
+/*
+ * Sparse products y = A x (SpMV) and Y = A X (SpMM) over a range of rows
+ * (CSR) or slices (SELL), so threads can each take a range. The AVX2 SpMV
+ * kernels gather x through the column indices, the SpMM ones read whole rows
+ * of X instead. They are used whenever the active ISA is AVX2 or wider,
+ * everything else runs the scalar loops.
+ */
+class SparseKernels {
+public:
+	static void SpmvCsr(const CsrMatrix& a, const float* x, float* y, size_t rowBegin, size_t rowEnd);
+	static void SpmvSell(const SellMatrix& a, const float* x, float* y, size_t sliceBegin, size_t sliceEnd);
+
+	static void SpmmCsr(const CsrMatrix& a, MatrixView<const float> x, MatrixView<float> y, size_t rowBegin, size_t rowEnd);
+	static void SpmmSell(const SellMatrix& a, MatrixView<const float> x, MatrixView<float> y, size_t sliceBegin, size_t sliceEnd);
+
+	/*
+	 * Splits the ranges described by offsets (rowOffsets or sliceOffsets) into
+	 * parts contiguous pieces holding about the same number of entries. Returns
+	 * parts + 1 boundaries; piece p is [bounds[p], bounds[p + 1]).
+	 */
+	static std::vector<size_t> PartitionByNonzeros(const std::vector<int64_t>& offsets, size_t parts);
+
+	static std::string GetKernelName();
+	static std::string FormatToString(SparseFormat format);
+};
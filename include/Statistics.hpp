@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#define OUTLIER_THRESHOLD 3.5  // Modified z-score above which a sample is flagged (Iglewicz & Hoaglin)
+
+/* Summary of repeated measurements of the same quantity */
+struct SampleStatistics {
+	size_t count = 0;
+	double min = 0.0;
+	double max = 0.0;
+	double median = 0.0;
+	double mean = 0.0;
+	double stddev = 0.0;   // Sample standard deviation (n - 1)
+	double mad = 0.0;      // Median absolute deviation, unscaled
+	double ciLow = 0.0;    // 95% confidence interval of the mean (Student t)
+	double ciHigh = 0.0;
+	double cv = 0.0;       // Coefficient of variation, stddev / mean
+	std::vector<size_t> outliers;  // Indices into the input samples
+};
+
+class Statistics {
+public:
+	static SampleStatistics Compute(const std::vector<double>& samples);
+
+	static double Median(std::vector<double> values);
+
+private:
+	/* Two-sided 97.5% quantile of Student's t distribution */
+	static double StudentT975(size_t degreesOfFreedom);
+};
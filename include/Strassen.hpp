@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+#include "Matrix.hpp"
+
+#define STRASSEN_MIN_SIZE 2048       // Smallest problem the Strassen test runs, the recursion does not pay off below
+#define STRASSEN_DEFAULT_CUTOFF 512  // Blocks of at most this size go to the classical packed GEMM
+
+/*
+ * Workspace of the Strassen recursion. One block is reserved up front and
+ * handed out by bumping an offset; each recursion level releases what it took
+ * before returning, so the peak is the sum of one chain of levels and nothing
+ * is allocated while a product runs.
+ */
+class StrassenArena {
+public:
+	/* Grows the block to at least floats elements, only ever reallocates when it is too small */
+	void Reserve(size_t floats);
+	size_t Capacity() const;
+
+	/* rows x cols block with cache-line aligned rows, contents undefined */
+	MatrixView<float> Allocate(size_t rows, size_t cols);
+
+	size_t Mark() const;
+	void Release(size_t mark);
+
+	static size_t BlockSize(size_t rows, size_t cols);  // Floats Allocate takes for such a block
+
+private:
+	Matrix<float> m_Buffer;
+	size_t m_Used = 0;
+};
+
+/* Classical product the recursion bottoms out in, C = A * B */
+using StrassenLeafMultiply = std::function<void(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c)>;
+
+/*
+ * Strassen-Winograd: 7 half-size products and 15 additions per level instead of
+ * 8 products. Uses the two-temporary schedule of Boyer, Dumas, Pernet and Zhou,
+ * with C's quadrants holding the intermediate products. Sizes that do not halve
+ * down to the cutoff are zero padded once at the top.
+ */
+class Strassen {
+public:
+	/* C = A * B for square n x n operands, recursing while blocks are larger than cutoff */
+	static void Multiply(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c,
+		size_t cutoff, StrassenArena& arena, const StrassenLeafMultiply& leaf);
+
+	/* Halvings until the blocks are at most cutoff */
+	static int RecursionDepth(size_t n, size_t cutoff);
+
+	/* Arena floats an n x n product needs, padding copies included */
+	static size_t WorkspaceSize(size_t n, size_t cutoff);
+
+private:
+	static void Recurse(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c,
+		size_t cutoff, StrassenArena& arena, const StrassenLeafMultiply& leaf);
+
+	static void Add(MatrixView<const float> x, MatrixView<const float> y, MatrixView<float> out);
+	static void Subtract(MatrixView<const float> x, MatrixView<const float> y, MatrixView<float> out);
+};
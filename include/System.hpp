@@ -1,38 +1,6 @@
 #pragma once
 #include <string>
-
-/* AVX2 Support Compile time and Runtime detection */
-#if defined(__AVX2__)
-constexpr auto hasAVX2ctime = true;
-#else
-constexpr auto hasAVX2ctime = false;
-#endif
-
-#ifdef _MSC_VER
-#include <intrin.h>
-#else 
-#include <cpuid.h>
-#endif
-
-static inline int check_avx2() {
-#ifdef _MSC_VER
-	int cpu_info[4];
-	__cpuid(cpu_info, 0);
-	if (cpu_info[0] < 7) return 0;
-
-	__cpuidex(cpu_info, 7, 0);
-	return (cpu_info[1] & (1 << 5)) != 0; // AVX2 bit
-#else
-	unsigned int eax, ebx, ecx, edx;
-	if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) && eax >= 7) {
-		__cpuid_count(7, 0, eax, ebx, ecx, edx);
-		return (ebx & (1 << 5)) != 0; // AVX2 bit
-	}
-	return 0;
-#endif
-}
-
-#define HAS_AVX2_RUNTIME check_avx2()
+#include <vector>
 
 #if defined(__cpp_lib_hardware_interference_size)
     #include <new>
@@ -57,23 +25,74 @@ static inline int check_avx2() {
 #if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
 	#include <cpuid.h>
 
-	inline size_t get_l1_cache_size() {
+	/*
+	 * Size in KB of the data or unified cache at the given level, walked from the
+	 * deterministic cache parameters leaf (4 on Intel, 0x8000001D on AMD). 0 if not reported.
+	 */
+	inline size_t get_cache_size_kb(unsigned int level) {
 		unsigned int eax, ebx, ecx, edx;
-		if (__get_cpuid(0x80000006, &eax, &ebx, &ecx, &edx)) {
-			return (ecx >> 16) & 0xFFFF;  // L1 cache size in KB
+		unsigned int leaf = 0;
+		if (__get_cpuid_max(0, nullptr) >= 4) {
+			__cpuid_count(4, 0, eax, ebx, ecx, edx);
+			if (eax & 0x1f)
+				leaf = 4;
+		}
+		if (leaf == 0 && __get_cpuid_max(0x80000000, nullptr) >= 0x8000001D)
+			leaf = 0x8000001D;
+		if (leaf == 0)
+			return 0;
+
+		for (unsigned int index = 0; index < 16; index++) {
+			__cpuid_count(leaf, index, eax, ebx, ecx, edx);
+			const unsigned int type = eax & 0x1f;  // 0 none, 1 data, 2 instruction, 3 unified
+			if (type == 0)
+				break;
+			if (type == 2 || ((eax >> 5) & 0x7) != level)
+				continue;
+
+			const size_t ways = ((ebx >> 22) & 0x3ff) + 1;
+			const size_t partitions = ((ebx >> 12) & 0x3ff) + 1;
+			const size_t lineSize = (ebx & 0xfff) + 1;
+			const size_t sets = static_cast<size_t>(ecx) + 1;
+			return ways * partitions * lineSize * sets / 1024;
 		}
-		return 32;  // Default 32KB if detection fails
+		return 0;
+	}
+
+	inline size_t get_l1_cache_size() {
+		const size_t size = get_cache_size_kb(1);
+		return size ? size : 32;  // L1 data cache size in KB, default 32KB if detection fails
+	}
+	inline size_t get_l2_cache_size() {
+		const size_t size = get_cache_size_kb(2);
+		return size ? size : 256;
+	}
+	inline size_t get_l3_cache_size() {
+		const size_t size = get_cache_size_kb(3);
+		return size ? size : 8 * 1024;
 	}
 	#define L1_CACHE_SIZE (get_l1_cache_size() * 1024)
+	#define L2_CACHE_SIZE (get_l2_cache_size() * 1024)
+	#define L3_CACHE_SIZE (get_l3_cache_size() * 1024)
 #elif defined(_MSC_VER)
 	#include <intrin.h>
 
 	inline size_t get_l1_cache_size() {
+		return 32 * 1024;  // Leaf 0x80000005 is AMD only, assume the common 32KB
+	}
+	inline size_t get_l2_cache_size() {
+		int cpu_info[4];
+		__cpuid(cpu_info, 0x80000006);
+		return (static_cast<size_t>((cpu_info[2] >> 16) & 0xFFFF)) * 1024;  // L2 cache size in bytes
+	}
+	inline size_t get_l3_cache_size() {
 		int cpu_info[4];
 		__cpuid(cpu_info, 0x80000006);
-		return (static_cast<size_t>((cpu_info[2] >> 16) & 0xFFFF)) * 1024;  // L1 cache size in bytes
+		return (static_cast<size_t>((cpu_info[3] >> 18) & 0x3FFF)) * 512 * 1024;  // L3 cache size in bytes
 	}
 	#define L1_CACHE_SIZE (get_l1_cache_size())
+	#define L2_CACHE_SIZE (get_l2_cache_size())
+	#define L3_CACHE_SIZE (get_l3_cache_size())
 #else
 	// Fallback to runtime detection using sysconf if available
 	#if defined(_SC_LEVEL1_DCACHE_SIZE)
@@ -82,9 +101,21 @@ static inline int check_avx2() {
 			long size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
 			return size > 0 ? size : 32 * 1024;
 		}
+		inline size_t get_l2_cache_size() {
+			long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+			return size > 0 ? size : 256 * 1024;
+		}
+		inline size_t get_l3_cache_size() {
+			long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+			return size > 0 ? size : 8 * 1024 * 1024;
+		}
 		#define L1_CACHE_SIZE (get_l1_cache_size())
+		#define L2_CACHE_SIZE (get_l2_cache_size())
+		#define L3_CACHE_SIZE (get_l3_cache_size())
 	#else
 		#define L1_CACHE_SIZE (32 * 1024)  // Default fallback
+		#define L2_CACHE_SIZE (256 * 1024)
+		#define L3_CACHE_SIZE (8 * 1024 * 1024)
 	#endif
 #endif
 
@@ -96,10 +127,20 @@ struct SystemInfo {
 	int64_t totalRAM;  // in bytes
 };
 
+/* One logical CPU and its position in the package/core hierarchy */
+struct CpuTopology {
+	int cpu;
+	int core;
+	int package;
+};
+
 class SystemDetector {
 public:
 	static SystemInfo GetSysInfo();
 
+	/* Logical CPUs this process may run on, ordered by OS CPU number */
+	static std::vector<CpuTopology> GetCpuTopology();
+
 private:
 	static std::string GetOS();
 	static std::string GetCPUModel();
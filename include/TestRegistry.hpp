@@ -0,0 +1,100 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchmarkTest.hpp"
+#include "Tests.hpp"
+
+enum class TestCategory {
+	GEMM,    // Dense matrix products
+	SPARSE,  // Sparse times dense products
+	SCALAR   // Scalar integer and floating point loops
+};
+
+/* Run modes a test supports, combined as bit flags */
+enum TestMode : unsigned {
+	TEST_MODE_SINGLE_THREADED = 1u << 0,  // Run() on the calling thread
+	TEST_MODE_MULTI_THREADED = 1u << 1,   // RunMultiThreaded(), also the scaling sweep
+	TEST_MODE_LATENCY = 1u << 2,          // Per-iteration latency histograms
+	TEST_MODE_OPEN_LOOP = 1u << 3,        // RunOpenLoop() at a target request rate
+	TEST_MODE_MATRIX_SWEEP = 1u << 4,     // Rebuilt at every size of the matrix sweep from params.matrixSize
+	/* Every run path; the sweep is left out because only tests with a matrix size can follow it */
+	TEST_MODE_ALL = TEST_MODE_SINGLE_THREADED | TEST_MODE_MULTI_THREADED | TEST_MODE_LATENCY | TEST_MODE_OPEN_LOOP
+};
+
+/* Fields of TestParams, combined as bit flags to record which ones the user chose */
+enum TestParam : unsigned {
+	TEST_PARAM_MATRIX_SIZE = 1u << 0,
+	TEST_PARAM_STRASSEN_CUTOFF = 1u << 1,
+	TEST_PARAM_SPARSE_SIZE = 1u << 2,
+	TEST_PARAM_SPARSE_DENSITY = 1u << 3,
+	TEST_PARAM_SPARSE_PATTERN = 1u << 4
+};
+
+/* Problem parameters handed to every factory; the member defaults are the tests' defaults */
+struct TestParams {
+	size_t matrixSize = DEFAULT_MATRIX_SIZE;
+	size_t strassenCutoff = STRASSEN_DEFAULT_CUTOFF;
+	SparseProblem sparse;
+	unsigned explicitParams = 0;  // TestParam flags of the fields the user set, the others take the test's own defaults
+};
+
+using TestFactory = std::function<std::unique_ptr<BenchmarkTest>(const TestParams& params)>;
+
+/* One registered test: metadata plus the factory that builds a fresh instance */
+struct TestInfo {
+	std::string name;
+	TestCategory category = TestCategory::SCALAR;
+	unsigned modes = TEST_MODE_ALL;
+	std::string description;
+	TestFactory factory;
+	TestParams defaults;  // What the test is built with for every parameter the user did not set
+
+	bool Supports(unsigned mode) const { return (modes & mode) == mode; }
+};
+
+/*
+ * Process-wide list of the available tests, filled by REGISTER_BENCHMARK
+ * during static initialization. Tests are only constructed when Create() is
+ * called, and every call returns a new instance, so the same test can be
+ * selected more than once per run.
+ */
+class TestRegistry {
+public:
+	/* Returns true so registrations can initialize a static; a duplicate name replaces the earlier entry */
+	static bool Register(TestInfo info);
+	static bool Register(std::string name, TestCategory category, unsigned modes, std::string description,
+		TestFactory factory, TestParams defaults = TestParams());
+
+	/* nullptr if no test of that name is registered */
+	static const TestInfo* Find(const std::string& name);
+	static std::unique_ptr<BenchmarkTest> Create(const std::string& name, const TestParams& params);
+
+	/* params with every field not flagged in params.explicitParams replaced by the test's own default */
+	static TestParams ApplyDefaults(const TestParams& params, const TestParams& defaults);
+
+	/* Sorted by name */
+	static std::vector<const TestInfo*> List();
+
+	static std::string CategoryToString(TestCategory category);
+	static TestCategory StringToCategory(const std::string& categoryStr);
+	static std::string ModesToString(unsigned modes);
+
+private:
+	static std::vector<TestInfo>& Entries();
+};
+
+#define BENCHMARK_REGISTRAR_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_REGISTRAR_CONCAT(a, b) BENCHMARK_REGISTRAR_CONCAT_IMPL(a, b)
+
+/*
+ * Registers a test from any translation unit linked into the executable:
+ *     REGISTER_BENCHMARK("my_test", TestCategory::SCALAR, TEST_MODE_SINGLE_THREADED | TEST_MODE_LATENCY, "What it measures",
+ *         [](const TestParams&) { return std::make_unique<MyTest>(); });
+ * A TestParams after the factory sets the test's own defaults, see TestInfo::defaults.
+ */
+#define REGISTER_BENCHMARK(name, category, modes, description, ...) \
+	static const bool BENCHMARK_REGISTRAR_CONCAT(s_BenchmarkRegistered, __LINE__) = \
+		TestRegistry::Register(name, category, modes, description, __VA_ARGS__)
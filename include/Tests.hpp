@@ -2,72 +2,284 @@
 #include <vector>
 
 #include "BenchmarkTest.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+#include "Sparse.hpp"
+#include "Strassen.hpp"
 #include "System.hpp"
 
-class MatrixMultiplicationTest : public BenchmarkTest {
+#define DEFAULT_MATRIX_SIZE 512
+#define TEST_INPUT_COUNT 4096  // Random operands prepared per test for RunSingleIteration to pick from
+#define VERIFY_SAMPLE_ROWS 16  // Rows of each GEMM product checked against the scalar reference, first and last included
+
+/* Square n x n x n product through GemmEngine<TA, TB, TC>, one product per iteration */
+template<typename TA, typename TB, typename TC>
+class GemmTest : public BenchmarkTest {
+public:
+	GemmTest(const std::string& testName, size_t matrixSize);
+
+	void SetUp() override;
+	/* Poisons C (NaN, or the largest integer), so Verify only passes on what the trial itself wrote */
+	void ResetTrial() override;
+	/* A product of its own for every open-loop worker */
+	void SetUpOpenLoop(int numThreads) override;
+	void TearDown() override;
+
+	void Run() override;
+	void RunMultiThreaded(int numThreads) override;
+	void RunSingleIteration(ThreadContext& context) override;
+
+	/* Sampled rows of C against a double reference, within n units of roundoff of sum |a||b| (exact for integers) */
+	void Verify() override;
+
+	size_t GetMatrixSize() const;
+
+	/* 2 * n^3 flops, one multiply and one add per inner product term; A and B read and C written once */
+	WorkPerIteration GetWork() const override;
+
+protected:
+	using Engine = GemmEngine<TA, TB, TC>;
+
+	size_t m_MatrixSize;
+	Matrix<TA> m_A;
+	Matrix<TB> m_B;
+	Matrix<TC> m_C;
+	GemmPackedB<typename Engine::PackedB> m_PackedB;  // B of the multi-threaded product, packed once and shared by the pool
+	std::vector<Matrix<TC>> m_WorkerC;  // Product of each open-loop worker, indexed by thread, empty outside open-loop runs
+
+	template<typename T>
+	void _InitializeMatrix(Matrix<T>& m, Xoshiro256& random);
+
+	void _ReservePackingBuffers();
+	void _GemmMultiThread(const Matrix<TA>& a, const Matrix<TB>& b, Matrix<TC>& c, int numThreads);
+};
+
+extern template class GemmTest<float, float, float>;
+extern template class GemmTest<double, double, double>;
+extern template class GemmTest<Float16, Float16, float>;
+extern template class GemmTest<BFloat16, BFloat16, float>;
+extern template class GemmTest<uint8_t, int8_t, int32_t>;
+
+class MatrixMultiplicationTest : public GemmTest<float, float, float> {
+public:
+	explicit MatrixMultiplicationTest(size_t matrixSize = DEFAULT_MATRIX_SIZE);
+};
+
+class MatrixMultiplicationFP64Test : public GemmTest<double, double, double> {
 public:
-	MatrixMultiplicationTest();
+	explicit MatrixMultiplicationFP64Test(size_t matrixSize = DEFAULT_MATRIX_SIZE);
+};
+
+/* FP16 storage, FP32 arithmetic */
+class MatrixMultiplicationFP16Test : public GemmTest<Float16, Float16, float> {
+public:
+	explicit MatrixMultiplicationFP16Test(size_t matrixSize = DEFAULT_MATRIX_SIZE);
+};
+
+/* BF16 operands, FP32 accumulation */
+class MatrixMultiplicationBF16Test : public GemmTest<BFloat16, BFloat16, float> {
+public:
+	explicit MatrixMultiplicationBF16Test(size_t matrixSize = DEFAULT_MATRIX_SIZE);
+};
+
+/* Unsigned times signed bytes into INT32, the VNNI operand convention */
+class MatrixMultiplicationInt8Test : public GemmTest<uint8_t, int8_t, int32_t> {
+public:
+	explicit MatrixMultiplicationInt8Test(size_t matrixSize = DEFAULT_MATRIX_SIZE);
+
+	WorkPerIteration GetWork() const override;  // Integer ops instead of flops
+};
+
+/*
+ * Strassen-Winograd product on the FP32 operands, bottoming out in the packed
+ * GEMM (tiled across threads in multi-threaded runs). Throughput is counted
+ * with the classical 2n^3, so it is the effective rate a caller sees. SetUp
+ * also computes the classical product, which TearDown compares against.
+ */
+class StrassenMultiplicationTest : public GemmTest<float, float, float> {
+public:
+	explicit StrassenMultiplicationTest(size_t matrixSize = STRASSEN_MIN_SIZE, size_t cutoff = STRASSEN_DEFAULT_CUTOFF);
+
+	void SetUp() override;
+	/* Adds a workspace of its own to the product of every open-loop worker */
+	void SetUpOpenLoop(int numThreads) override;
+	void TearDown() override;
 
 	void Run() override;
 	void RunMultiThreaded(int numThreads) override;
-	void RunSingleIteration() override;
+	void RunSingleIteration(ThreadContext& context) override;
+
+	/* Fails when the error against the classical product exceeds 3^depth times the classical bound */
+	void Verify() override;
+
+	size_t GetCutoff() const;
+
+	/* max |C - C_classical| / max |C_classical| of the last verified product, negative before the first Verify */
+	double GetMaxRelativeError() const;
 
 private:
-	void _InitializeMatrix(std::vector<std::vector<float>>& m);
-
-	void _BasicMultiplicationSingleThread(const std::vector<std::vector<float>>& a,
-								          const std::vector<std::vector<float>>& b,
-			                              std::vector<std::vector<float>>& c,
-		                                  size_t startRow, size_t endRow);
-	void _BasicMultiplicationMultiThread(const std::vector<std::vector<float>>& a,
-			                             const std::vector<std::vector<float>>& b,
-			                             std::vector<std::vector<float>>& c);
-
-	void _AVX2MultiplicationSingleThread(const std::vector<std::vector<float>>& a,
-			                             const std::vector<std::vector<float>>& b,
-			                             std::vector<std::vector<float>>& c,
-		                                 size_t startRow, size_t endRow);
-	void _AVX2MultiplicationMultiThread(const std::vector<std::vector<float>>& a,
-			                            const std::vector<std::vector<float>>& b,
-			                            std::vector<std::vector<float>>& c);
+	size_t m_Cutoff;
+	Matrix<float> m_Reference;
+	StrassenArena m_Arena;
+	std::vector<StrassenArena> m_WorkerArenas;  // Workspace of each open-loop worker, indexed by thread, empty outside open-loop runs
+	double m_MaxRelativeError = -1.0;
+};
+
+/* Generated sparse matrix shared by the sparse tests */
+struct SparseProblem {
+	size_t size = SPARSE_DEFAULT_SIZE;
+	double density = SPARSE_DEFAULT_DENSITY;
+	SparsePattern pattern = DEFAULT_SPARSE_PATTERN;
 };
 
-class IntegerArithmeticTest : public BenchmarkTest {
+/*
+ * Sparse times dense product on a generated square matrix, one product per
+ * iteration: SpMV for a single dense column, SpMM for several. Threads take
+ * contiguous row (CSR) or slice (SELL) ranges holding equal shares of the
+ * nonzeros. These kernels are bound by streaming the matrix, so besides the
+ * 2 * nnz * columns FLOPs the test reports its compulsory traffic.
+ */
+class SparseTest : public BenchmarkTest {
+public:
+	SparseTest(const std::string& testName, SparseFormat format, size_t denseColumns, const SparseProblem& problem);
+
+	void SetUp() override;
+	/* Fills y with NaN, so a row the trial skipped fails Verify */
+	void ResetTrial() override;
+	/* A result of its own for every open-loop worker */
+	void SetUpOpenLoop(int numThreads) override;
+	void TearDown() override;
+
+	void Run() override;
+	void RunMultiThreaded(int numThreads) override;
+	void RunSingleIteration(ThreadContext& context) override;
+
+	/* Every row against a double CSR reference, within row length units of roundoff of sum |a||x| */
+	void Verify() override;
+
+	/* 2 flops per stored nonzero and dense column, from the matrix of the last SetUp; 0 before the first one */
+	WorkPerIteration GetWork() const override;
+
+private:
+	SparseFormat m_Format;
+	size_t m_DenseColumns;
+	SparseProblem m_Problem;
+	CsrMatrix m_Csr;   // Kept next to the SELL copy as the reference
+	SellMatrix m_Sell;
+	std::vector<float> m_X;  // size x denseColumns, row-major
+	std::vector<float> m_Y;
+	std::vector<std::vector<float>> m_WorkerY;  // Result of each open-loop worker, indexed by thread, empty outside open-loop runs
+	size_t m_Nonzeros = 0;
+	double m_BytesPerIteration = 0.0;
+
+	/* Rows (CSR) or slices (SELL) [begin, end) of y = A x */
+	void Multiply(size_t begin, size_t end, std::vector<float>& y) const;
+	size_t RangeCount() const;
+	const std::vector<int64_t>& RangeOffsets() const;
+};
+
+class SpmvCsrTest : public SparseTest {
+public:
+	explicit SpmvCsrTest(const SparseProblem& problem = SparseProblem());
+};
+
+class SpmvSellTest : public SparseTest {
+public:
+	explicit SpmvSellTest(const SparseProblem& problem = SparseProblem());
+};
+
+class SpmmCsrTest : public SparseTest {
+public:
+	explicit SpmmCsrTest(const SparseProblem& problem = SparseProblem());
+};
+
+class SpmmSellTest : public SparseTest {
+public:
+	explicit SpmmSellTest(const SparseProblem& problem = SparseProblem());
+};
+
+class IntegerArithmeticTest : public BatchedTest<IntegerArithmeticTest> {
 public:
 	IntegerArithmeticTest();
 
+	void SetUp() override;
+	void TearDown() override;
 	void Run() override;
-	void RunSingleIteration() override;
+	void Verify() override;
+	WorkPerIteration GetWork() const override;
+
+	/* One random operand pair through the multiply-add-xor-rotate chain, INT_OPS_PER_ITERATION operations */
+	uint64_t Iteration(ThreadContext& context);
 
 private:
-	constexpr static size_t ITERATION_COUNT = 1'000;
-	
-	constexpr static int64_t MULTIPLIER = 1'103'515'245;
-	constexpr static int64_t INCREMENT = 12345;
-	constexpr static int64_t MASK = 0x7fffffff;
+	std::vector<int64_t> m_Inputs;
+
+	constexpr static uint64_t MULTIPLIER = 1'103'515'245;
+	constexpr static uint64_t INCREMENT = 12345;
+	constexpr static uint64_t MASK = 0x7fffffff;
+	constexpr static int INT_OPS_PER_ITERATION = 11;  // Product term 3, accumulate 1, PerformOperations 6, final add 1
 
-	int64_t PerformOperations(int64_t result);
+	/* Known answer of Accumulate(VERIFY_ITERATIONS), computed independently with 64-bit wraparound */
+	constexpr static int64_t VERIFY_ITERATIONS = 4096;
+	constexpr static int64_t VERIFY_CHECKSUM = 0x35d817c5a730dd30;
+	/* Known answer of VERIFY_ITERATIONS Iteration() calls on operand j = j * 0x9E3779B1 & MASK and stream Xoshiro256(VERIFY_SEED) */
+	constexpr static uint64_t VERIFY_SEED = 1;
+	constexpr static uint64_t VERIFY_ITERATION_CHECKSUM = 0x85df95916ba324c4;
+
+	int64_t Accumulate(int64_t iterations);
+	uint64_t PerformOperations(uint64_t result);
 };
 
-class FloatingPointTest : public BenchmarkTest {
+class FloatingPointTest : public BatchedTest<FloatingPointTest> {
 public:
 	FloatingPointTest();
+	void SetUp() override;
+	void TearDown() override;
 	void Run() override;
-	void RunSingleIteration() override;
+
+	/* Transcendental mix on one random operand pair */
+	benchmark_float_type Iteration(ThreadContext& context);
+
+	/* Math library calls, MATH_CALLS_PER_ITERATION per Iteration() on every path */
+	WorkPerIteration GetWork() const override;
+
+	/* Closed forms, and long double references for the helper loops and for Iteration() on fixed operands */
+	void Verify() override;
 
 private:
-	benchmark_float_type BasicArithmeticTest();
-	benchmark_float_type TranscendentalTest();
-	benchmark_float_type SpecialCasesTest();
+	std::vector<benchmark_float_type> m_Inputs;  // Pairs of operands
+
+	constexpr static int64_t VERIFY_ITERATIONS = 4096;
+	constexpr static double VERIFY_TOLERANCE = 1e-9;  // Relative to the sum of the term magnitudes
+	constexpr static int MATH_CALLS_PER_ITERATION = 8;
+	constexpr static uint64_t VERIFY_SEED = 1;  // Stream Verify picks its fixed operands with
+
+	benchmark_float_type BasicArithmeticTest(int64_t iterations);
+	benchmark_float_type TranscendentalTest(int64_t iterations);
 	benchmark_float_type PrecisionTest();
 };
 
-class PrimeTest : public BenchmarkTest {
+class PrimeTest : public BatchedTest<PrimeTest> {
 public:
 	PrimeTest();
+	void SetUp() override;
+	void TearDown() override;
 	void Run() override;
-	void RunSingleIteration() override;
+
+	/* Primality of one random input, 1 when prime */
+	int Iteration(ThreadContext& context);
+
+	/* One random number tested per iteration, on every path */
+	WorkPerIteration GetWork() const override;
+
+	/* Counts the primes below 10^7 against the known pi(10^7) */
+	void Verify() override;
 
 private:
+	std::vector<int> m_Inputs;
+
+	constexpr static int VERIFY_LIMIT = 10'000'000;
+	constexpr static int VERIFY_PRIME_COUNT = 664'579;
+
 	bool isPrime(int n);
 };
\ No newline at end of file
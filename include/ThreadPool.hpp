@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Persistent worker pool shared by all tests. Workers are created once and
+ * parked on a condition variable between jobs; Run() releases the requested
+ * number of workers at once and blocks until every one of them has returned,
+ * so thread creation never lands inside a timed region.
+ */
+class ThreadPool {
+public:
+	using Job = std::function<void(int threadIndex)>;
+
+	/* Worker i is pinned to cpuMapping[i] when a mapping is given */
+	explicit ThreadPool(int numThreads, const std::vector<int>& cpuMapping = {});
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/* Runs job on workers [0, numThreads), rethrows the first exception raised by any of them */
+	void Run(int numThreads, const Job& job);
+	void Run(const Job& job);
+
+	int GetSize() const;
+
+	/* OS thread ids of the workers (Linux tids), used to attach per-thread performance counters */
+	std::vector<int64_t> GetThreadIds() const;
+
+private:
+	std::vector<std::thread> m_Workers;
+	std::vector<int64_t> m_ThreadIds;
+	std::mutex m_Mutex;
+	std::condition_variable m_StartCondition;
+	std::condition_variable m_DoneCondition;
+
+	const Job* m_Job = nullptr;
+	int m_ActiveThreads = 0;
+	int m_PendingThreads = 0;
+	uint64_t m_Generation = 0;
+	bool m_ShouldExit = false;
+	std::exception_ptr m_Error;
+
+	void WorkerLoop(int threadIndex, int cpu);
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+	#define BENCHMARK_HAS_TSC 1
+#elif defined(__i386__) || defined(__x86_64__)
+	#include <x86intrin.h>
+	#define BENCHMARK_HAS_TSC 1
+#else
+	#define BENCHMARK_HAS_TSC 0
+#endif
+
+#define TIMER_CALIBRATION_SAMPLES 1000
+#define TSC_CALIBRATION_INTERVAL std::chrono::milliseconds(50)
+
+/* Elapsed time of one measured region with the timer overhead already removed */
+struct TimingResult {
+	int64_t nanoseconds = 0;
+	uint64_t cycles = 0;  // Reference (TSC) cycles, 0 when no cycle counter is available
+
+	double Milliseconds() const { return nanoseconds / 1e6; }
+};
+
+/*
+ * Monotonic timing layer used by measureExecTime. Every region is stamped
+ * with steady_clock and, on x86, with a fenced TSC read. When the TSC is
+ * invariant it is used as the time source too, since it has finer
+ * resolution and a cheaper read than the clock syscall path.
+ * Calibrate() must run once before any measurement.
+ */
+class Timer {
+public:
+	struct Stamp {
+		int64_t nanoseconds;
+		uint64_t cycles;
+	};
+
+	static void Calibrate();
+
+	static bool HasInvariantTSC();
+	static double GetTscFrequencyHz();  // 0 when unknown
+	static int64_t GetOverheadNs();
+	static uint64_t GetOverheadCycles();
+	static std::string GetSourceName();
+
+	static inline Stamp Start() {
+		Stamp stamp;
+		stamp.nanoseconds = NowNs();
+		stamp.cycles = ReadCyclesBegin();
+		return stamp;
+	}
+
+	static inline Stamp Stop() {
+		Stamp stamp;
+		stamp.cycles = ReadCyclesEnd();
+		stamp.nanoseconds = NowNs();
+		return stamp;
+	}
+
+	static TimingResult Elapsed(const Stamp& start, const Stamp& end);
+
+	static inline int64_t NowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/* lfence keeps earlier instructions from drifting past the read and later ones from starting before it */
+	static inline uint64_t ReadCyclesBegin() {
+#if BENCHMARK_HAS_TSC
+		_mm_lfence();
+		uint64_t cycles = __rdtsc();
+		_mm_lfence();
+		return cycles;
+#else
+		return 0;
+#endif
+	}
+
+	/* rdtscp waits for all earlier instructions to retire, the trailing lfence fences off what follows */
+	static inline uint64_t ReadCyclesEnd() {
+#if BENCHMARK_HAS_TSC
+		unsigned int aux;
+		uint64_t cycles = __rdtscp(&aux);
+		_mm_lfence();
+		return cycles;
+#else
+		return 0;
+#endif
+	}
+
+private:
+	static bool s_InvariantTSC;
+	static double s_TscFrequencyHz;
+	static int64_t s_OverheadNs;
+	static uint64_t s_OverheadCycles;
+
+	static bool DetectInvariantTSC();
+	static double MeasureTscFrequency();
+};
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+#include "Affinity.hpp"
+#include "Logger.hpp"
+
+std::vector<int> ThreadPlacement::BuildCpuMapping(PlacementPolicy policy, int numThreads,
+                                                  const std::vector<int>& cpuList)
+{
+	if (policy == PlacementPolicy::NONE || numThreads < 1)
+		return {};
+
+	std::vector<int> order;
+	if (policy == PlacementPolicy::LIST) {
+		if (cpuList.empty()) {
+			throw std::invalid_argument("Placement policy 'list' requires a non-empty CPU list");
+		}
+		order = cpuList;
+	}
+	else {
+		std::vector<CpuTopology> topology = SystemDetector::GetCpuTopology();
+		if (topology.empty()) {
+			LOG_WARNING("CPU topology unavailable, threads will not be pinned");
+			return {};
+		}
+
+		/* Group logical CPUs by physical core, SMT siblings stay in OS order within a core */
+		std::map<std::pair<int, int>, std::vector<int>> cores;
+		for (const CpuTopology& entry : topology)
+			cores[{ entry.package, entry.core }].push_back(entry.cpu);
+
+		switch (policy) {
+		case PlacementPolicy::COMPACT:
+			for (const CpuTopology& entry : topology)
+				order.push_back(entry.cpu);
+			break;
+
+		case PlacementPolicy::SMT_SIBLINGS:
+			for (const auto& core : cores)
+				order.insert(order.end(), core.second.begin(), core.second.end());
+			break;
+
+		case PlacementPolicy::SCATTER: {
+			/* Group cores by package, then deal one core from each package in turn */
+			std::map<int, std::vector<const std::vector<int>*>> packages;
+			size_t maxSiblings = 0;
+			for (const auto& core : cores) {
+				packages[core.first.first].push_back(&core.second);
+				maxSiblings = std::max(maxSiblings, core.second.size());
+			}
+
+			for (size_t rank = 0; rank < maxSiblings; ++rank) {
+				for (size_t coreIdx = 0; ; ++coreIdx) {
+					bool anyLeft = false;
+					for (const auto& package : packages) {
+						if (coreIdx >= package.second.size())
+							continue;
+						anyLeft = true;
+						const std::vector<int>& siblings = *package.second[coreIdx];
+						if (rank < siblings.size())
+							order.push_back(siblings[rank]);
+					}
+					if (!anyLeft)
+						break;
+				}
+			}
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	if (static_cast<int>(order.size()) < numThreads) {
+		LOG_WARNING("More threads (" + std::to_string(numThreads) + ") than CPUs in the placement ("
+			+ std::to_string(order.size()) + "), CPUs will be shared");
+	}
+
+	std::vector<int> mapping(numThreads);
+	for (int t = 0; t < numThreads; ++t)
+		mapping[t] = order[t % order.size()];
+	return mapping;
+}
+
+bool ThreadPlacement::PinCurrentThread(int cpu) {
+#if defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE)
+		return false;
+
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+std::string ThreadPlacement::MappingToString(const std::vector<int>& mapping) {
+	if (mapping.empty())
+		return "unpinned";
+
+	std::ostringstream oss;
+	for (size_t i = 0; i < mapping.size(); ++i) {
+		if (i > 0)
+			oss << ";";
+		oss << mapping[i];
+	}
+	return oss.str();
+}
+
+std::string ThreadPlacement::PlacementPolicyToString(PlacementPolicy policy) {
+	switch (policy) {
+	case PlacementPolicy::NONE:			return "none";
+	case PlacementPolicy::COMPACT:		return "compact";
+	case PlacementPolicy::SCATTER:		return "scatter";
+	case PlacementPolicy::SMT_SIBLINGS:	return "smt";
+	case PlacementPolicy::LIST:			return "list";
+	default:							return "unknown";
+	}
+}
+
+PlacementPolicy ThreadPlacement::StringToPlacementPolicy(const std::string& policyStr) {
+	if (policyStr == "none")			return PlacementPolicy::NONE;
+	else if (policyStr == "compact")	return PlacementPolicy::COMPACT;
+	else if (policyStr == "scatter")	return PlacementPolicy::SCATTER;
+	else if (policyStr == "smt")		return PlacementPolicy::SMT_SIBLINGS;
+	else if (policyStr == "list")		return PlacementPolicy::LIST;
+	else								return DEFAULT_PLACEMENT_POLICY;
+}
@@ -1,8 +1,13 @@
+#include <iomanip>
+#include <iostream>
+
 #include "Benchmark.hpp"
 #include "BenchmarkTest.hpp"
 #include "Logger.hpp"
 #include "Parser.hpp"
+#include "PluginLoader.hpp"
 #include "System.hpp"
+#include "TestRegistry.hpp"
 #include "Tests.hpp"
 
 /* JSON Parsing */
@@ -32,16 +37,68 @@ int main(int argc, char* argv[]) {
 
 		LOG_INFO("CPU Benchmark tool started");
 
-		CPUBenchmark benchmark(arg_parser.threads());
+		PluginLoader::LoadDirectory(arg_parser.plugin_dir());
+
+		if (arg_parser.list_tests()) {
+			for (const TestInfo* info : TestRegistry::List()) {
+				std::cout << std::left << std::setw(40) << info->name << std::setw(8) << TestRegistry::CategoryToString(info->category)
+					<< std::setw(36) << TestRegistry::ModesToString(info->modes) << info->description << std::endl;
+			}
+			return 0;
+		}
+
+		BenchmarkOptions options;
+		options.threads = arg_parser.threads();
+		options.schedule = arg_parser.schedule();
+		options.chunkSize = arg_parser.chunk_size();
+		options.placement = arg_parser.affinity();
+		options.cpuList = arg_parser.cpu_list();
+		options.warmup = arg_parser.warmup();
+		options.repetitions = arg_parser.repetitions();
+		options.iterations = arg_parser.iterations();
+		options.minTimeMs = arg_parser.min_time_ms();
+		options.perfCounters = arg_parser.perf_counters();
+		options.scaling = arg_parser.scaling();
+		options.scalingThreads = arg_parser.scaling_threads();
+		options.latency = arg_parser.latency();
+		options.loadRates = arg_parser.load_rates();
+		options.arrival = arg_parser.arrival();
+		options.loadDurationMs = arg_parser.load_duration_ms();
+		options.hugePages = arg_parser.huge_pages();
+		options.matrixSize = arg_parser.matrix_size();
+		options.matrixSweep = arg_parser.matrix_sweep();
+		options.matrixSizes = arg_parser.matrix_sizes();
+		options.strassenCutoff = arg_parser.strassen_cutoff();
+		options.sparseSize = arg_parser.sparse_size();
+		options.sparseDensity = arg_parser.sparse_density();
+		options.sparsePattern = arg_parser.sparse_pattern();
+		options.explicitTestParams = arg_parser.explicit_test_params();
+		options.isa = arg_parser.isa();
+		options.seed = arg_parser.seed();
+
+		CPUBenchmark benchmark(options);
 		
 		std::vector<std::string> avail_testnames = arg_parser.GetTestNames();
 		for (const std::string& testname : avail_testnames) {
-			std::unique_ptr<BenchmarkTest> test = benchmark.FindTest(testname);
+			std::unique_ptr<BenchmarkTest> test = benchmark.CreateTest(testname);
 			if (test != nullptr)
 				benchmark.AddTest(std::move(test));
 		}
 
-		benchmark.RunAllTests();
+		if (options.scaling)
+			benchmark.RunScalingSweep();
+		else if (!options.loadRates.empty())
+			benchmark.RunLoadSweep();
+		else if (options.matrixSweep || !options.matrixSizes.empty())
+			benchmark.RunMatrixSweep();
+		else
+			benchmark.RunAllTests();
+
+		if (benchmark.GetVerificationFailures() > 0) {
+			LOG_ERROR(std::to_string(benchmark.GetVerificationFailures()) + " test(s) failed verification");
+			std::cerr << benchmark.GetVerificationFailures() << " test(s) failed verification, see benchmark.log" << std::endl;
+			return 1;
+		}
 
 		LOG_INFO("CPU Benchmark tool finished successfully");
 	}
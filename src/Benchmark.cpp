@@ -1,31 +1,120 @@
 #include <iostream>
 #include <vector>
 #include <iomanip>
+#include <algorithm>
+#include <sstream>
 
 #include "Benchmark.hpp"
+#include "Statistics.hpp"
 #include "Tests.hpp"
+#include "Gemm.hpp"
 #include "Logger.hpp"
+#include "Matrix.hpp"
+#include "Roofline.hpp"
+#include "TestRegistry.hpp"
 
-CPUBenchmark::CPUBenchmark(int numThreads) : m_ThreadCount(numThreads) {
+/* Negative values mark metrics that could not be measured, they are left empty in the report */
+static std::string formatMetric(double value) {
+	if (value < 0.0)
+		return "";
+
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(3) << value;
+	return oss.str();
+}
+
+CPUBenchmark::CPUBenchmark(const BenchmarkOptions& options)
+	: m_ThreadCount(options.threads),
+	m_IterationCount(options.iterations),
+	m_MinTimeMs(options.minTimeMs),
+	m_ScheduleMode(options.schedule),
+	m_ChunkSize(options.chunkSize),
+	m_Placement(options.placement),
+	m_WarmupCount(options.warmup),
+	m_RepetitionCount(std::max(options.repetitions, 1)),
+	m_UsePerfCounters(options.perfCounters),
+	m_RecordLatency(options.latency),
+	m_LoadRates(options.loadRates),
+	m_Arrival(options.arrival),
+	m_LoadDurationMs(options.loadDurationMs),
+	m_Seed(options.seed != DEFAULT_RANDOM_SEED ? options.seed : Xoshiro256::RandomSeed())
+{
 	m_UseMultiThreading = m_ThreadCount > 1;
 
+	m_TestParams.matrixSize = static_cast<size_t>(std::max(options.matrixSize, 1));
+	m_TestParams.strassenCutoff = static_cast<size_t>(std::max(options.strassenCutoff, 1));
+	m_TestParams.sparse.size = static_cast<size_t>(std::max(options.sparseSize, 1));
+	m_TestParams.sparse.density = std::min(std::max(options.sparseDensity, 0.0), 1.0);
+	m_TestParams.sparse.pattern = options.sparsePattern;
+	m_TestParams.explicitParams = options.explicitTestParams;
+	LOG_INFO("Random seed: " + std::to_string(m_Seed) + " (--seed=" + std::to_string(m_Seed) + " reproduces the test data)");
+
 	m_SysInfo = SystemDetector::GetSysInfo();
 	m_ReportFile.open("benchmark_report.csv");
 
-	m_ReportFile << "Operating System, CPU Model, Num of Cores, Total Phys RAM (GB)" << std::endl;
+	Timer::Calibrate();
+	AlignedAllocator::SetHugePages(options.hugePages);
+	const SimdIsa isa = IsaDispatch::Select(options.isa);
+
+	m_ReportFile << "Operating System, CPU Model, Num of Cores, Total Phys RAM (GB), Timer Source, TSC Frequency (MHz), Timer Overhead (ns), SIMD ISA, GEMM Kernel, Random Seed" << std::endl;
 	m_ReportFile << m_SysInfo.operatingSystem << ","
 		<< m_SysInfo.cpuModel << ","
 		<< m_SysInfo.numCores << ","
-		<< std::fixed << std::setprecision(2) << (m_SysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)) << std::endl;
+		<< std::fixed << std::setprecision(2) << (m_SysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)) << ","
+		<< Timer::GetSourceName() << ","
+		<< Timer::GetTscFrequencyHz() / 1e6 << ","
+		<< Timer::GetOverheadNs() << ","
+		<< IsaDispatch::IsaToString(isa) << ","
+		<< Gemm::GetKernelName() << ","
+		<< m_Seed << std::endl;
 		
 	m_ReportFile << std::endl;
-		
-	m_ReportFile << "Test Name,Score,Duration (ms)" << std::endl;
 
-	LOG_INFO("CPUBenchmark initialized with " + std::to_string(m_ThreadCount) + " threads");
-	logSystemInfo();
+	/* The pool has to cover the largest thread count of the sweep */
+	int poolSize = m_ThreadCount;
+	if (options.scaling) {
+		m_ScalingThreads = options.scalingThreads;
+		if (m_ScalingThreads.empty()) {
+			for (int threads = 1; threads < m_SysInfo.numCores; threads *= 2)
+				m_ScalingThreads.push_back(threads);
+			m_ScalingThreads.push_back(std::max(m_SysInfo.numCores, 1));
+		}
+		std::sort(m_ScalingThreads.begin(), m_ScalingThreads.end());
+		m_ScalingThreads.erase(std::unique(m_ScalingThreads.begin(), m_ScalingThreads.end()), m_ScalingThreads.end());
+		poolSize = m_ScalingThreads.back();
+	}
+
+	if (options.matrixSweep || !options.matrixSizes.empty()) {
+		m_MatrixSizes = options.matrixSizes;
+		if (m_MatrixSizes.empty()) {
+			/* Midpoints are not powers of two, so aliasing cliffs at the powers show up against their neighbours */
+			for (int size = MATRIX_SWEEP_MIN_SIZE; size <= MATRIX_SWEEP_MAX_SIZE; size *= 2) {
+				m_MatrixSizes.push_back(size);
+				if (size < MATRIX_SWEEP_MAX_SIZE)
+					m_MatrixSizes.push_back(size + size / 2);
+			}
+		}
+	}
+
+	m_CpuMapping = ThreadPlacement::BuildCpuMapping(m_Placement, poolSize, options.cpuList);
+
+	/* Workers are created once here so that thread startup stays out of every timed region */
+	if (m_UseMultiThreading || options.scaling || m_RecordLatency || !m_LoadRates.empty())
+		m_Pool = std::make_unique<ThreadPool>(poolSize, m_CpuMapping);
+	else if (!m_CpuMapping.empty() && !ThreadPlacement::PinCurrentThread(m_CpuMapping.front()))
+		LOG_WARNING("Failed to pin the benchmark thread to CPU " + std::to_string(m_CpuMapping.front()));
+
+	/* Counters are opened after the pool exists so each worker gets its own group */
+	if (m_UsePerfCounters)
+		m_UsePerfCounters = m_PerfCounters.Open(m_Pool ? m_Pool->GetThreadIds() : std::vector<int64_t>{});
 
-	createTestsMap();
+	LOG_INFO("CPUBenchmark initialized with " + std::to_string(m_ThreadCount) + " threads, "
+		+ WorkScheduler::ScheduleModeToString(m_ScheduleMode) + " schedule, "
+		+ ThreadPlacement::PlacementPolicyToString(m_Placement) + " placement (CPUs: "
+		+ ThreadPlacement::MappingToString(m_CpuMapping) + ")"
+		+ (options.hugePages ? ", huge pages enabled" : ""));
+	LOG_INFO("SIMD ISA: " + IsaDispatch::IsaToString(isa) + " (GEMM microkernel " + Gemm::GetKernelName() + ")");
+	logSystemInfo();
 }
 
 CPUBenchmark::~CPUBenchmark() {
@@ -41,47 +130,255 @@ void CPUBenchmark::logSystemInfo() {
 	LOG_INFO("Total Physical RAM: " + std::to_string(m_SysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)) + " GB");
 }
 
-void CPUBenchmark::createTestsMap()
-{
-	m_TestsMap.emplace("matrix_multiplication_test", std::make_unique<MatrixMultiplicationTest>());
-	m_TestsMap.emplace("integer_arithmetic_test", std::make_unique<IntegerArithmeticTest>());
-	m_TestsMap.emplace("floating_point_test", std::make_unique<FloatingPointTest>());
-	m_TestsMap.emplace("prime_calculation_test", std::make_unique<PrimeTest>());
+void CPUBenchmark::configureTest(BenchmarkTest& test) {
+	test.SetSchedule(m_ScheduleMode, m_ChunkSize);
+	test.SetThreadPool(m_Pool.get());
+	test.SetLatencyRecording(m_RecordLatency);
+	test.SetSeed(m_Seed);
 }
 
-
 void CPUBenchmark::AddTest(std::unique_ptr<BenchmarkTest> test) {
+	configureTest(*test);
 	m_Tests.push_back(std::move(test));
 	LOG_INFO("Added test: " + m_Tests.back()->GetName());
 }
 
-std::unique_ptr<BenchmarkTest> CPUBenchmark::FindTest(const std::string& testname)
+std::unique_ptr<BenchmarkTest> CPUBenchmark::CreateTest(const std::string& testname)
 {
-	if (m_TestsMap.find(testname) != m_TestsMap.end()) {
-		return std::move(m_TestsMap[testname]);
+	const TestInfo* info = TestRegistry::Find(testname);
+	if (info == nullptr) {
+		LOG_WARNING("Unknown test " + testname + ", skipped");
+		return nullptr;
+	}
+
+	const unsigned mode = requiredTestMode();
+	if (!info->Supports(mode)) {
+		LOG_WARNING(testname + " does not support " + TestRegistry::ModesToString(mode) + " runs, skipped");
+		return nullptr;
 	}
-	return nullptr;
+	return TestRegistry::Create(testname, m_TestParams);
+}
+
+unsigned CPUBenchmark::requiredTestMode() const {
+	if (!m_LoadRates.empty())
+		return TEST_MODE_OPEN_LOOP;
+
+	unsigned mode = (m_UseMultiThreading || !m_ScalingThreads.empty()) ? TEST_MODE_MULTI_THREADED : TEST_MODE_SINGLE_THREADED;
+	if (m_RecordLatency)
+		mode |= TEST_MODE_LATENCY;
+	if (!m_MatrixSizes.empty())
+		mode |= TEST_MODE_MATRIX_SWEEP;
+	return mode;
+}
+
+TimingResult CPUBenchmark::runTrial(BenchmarkTest& test, int numThreads, PerfCounterValues* counters) {
+	test.ResetTrial();
+	test.PrepareThreadContexts(std::max(numThreads, 1));
+
+	/* Counters cover the same region as the timer, the untimed reset and context setup above stay out */
+	const bool countEvents = counters != nullptr && m_UsePerfCounters;
+	if (countEvents)
+		m_PerfCounters.Start();
+	const TimingResult timing = numThreads > 0
+		? measureExecTime([&]() { test.RunMultiThreaded(numThreads); })
+		: measureExecTime([&]() { test.Run(); });
+	if (countEvents)
+		*counters += m_PerfCounters.Stop();
+	return timing;
+}
+
+void CPUBenchmark::calibrateIterations(BenchmarkTest& test, int numThreads) {
+	/* Same growth rule as Google Benchmark: aim 40% past the target, never grow more than 10x per step */
+	const double targetNs = m_MinTimeMs * 1e6;
+	int64_t iterations = 1;
+
+	while (true) {
+		test.SetIterationCount(iterations);
+		const double elapsedNs = static_cast<double>(runTrial(test, numThreads).nanoseconds);
+		LOG_DEBUG(test.GetName() + " calibration: " + std::to_string(iterations) + " iterations took " + std::to_string(elapsedNs) + " ns");
+
+		if (elapsedNs >= targetNs || iterations >= BENCHMARK_MAX_ITERATION_COUNT)
+			break;
+
+		double multiplier = 10.0;
+		if (elapsedNs / targetNs > 0.1)
+			multiplier = std::min(10.0, targetNs * 1.4 / std::max(elapsedNs, 1.0));
+
+		const int64_t next = static_cast<int64_t>(iterations * multiplier);
+		iterations = std::min<int64_t>(std::max(next, iterations + 1), BENCHMARK_MAX_ITERATION_COUNT);
+	}
+
+	LOG_INFO(test.GetName() + " calibrated to " + std::to_string(iterations) + " iterations for a "
+		+ std::to_string(m_MinTimeMs) + " ms trial");
+}
+
+TestMeasurement CPUBenchmark::measureTest(BenchmarkTest& test, int numThreads) {
+	/* Allocation and initialization stay outside every timed trial, including calibration and warmup */
+	test.SetUp();
+	try {
+		TestMeasurement measurement = measurePreparedTest(test, numThreads);
+		verifyTest(test);
+		test.TearDown();
+		return measurement;
+	}
+	catch (...) {
+		test.TearDown();
+		throw;
+	}
+}
+
+void CPUBenchmark::verifyTest(BenchmarkTest& test) {
+	try {
+		test.Verify();
+	}
+	catch (const VerificationException&) {
+		++m_VerificationFailures;
+		throw;
+	}
+	LOG_DEBUG(test.GetName() + " verified");
+}
+
+int CPUBenchmark::GetVerificationFailures() const {
+	return m_VerificationFailures;
+}
+
+TestMeasurement CPUBenchmark::measurePreparedTest(BenchmarkTest& test, int numThreads) {
+	if (numThreads > 0) {
+		LOG_DEBUG("Measuring " + test.GetName() + " on " + std::to_string(numThreads) + " threads ("
+			+ WorkScheduler::ScheduleModeToString(m_ScheduleMode) + " schedule)");
+	}
+
+	if (m_IterationCount > 0)
+		test.SetIterationCount(m_IterationCount);
+	else if (m_MinTimeMs > 0)
+		calibrateIterations(test, numThreads);
+
+	/* Warmup trials settle caches, page mappings and clock frequency and are discarded */
+	for (int i = 0; i < m_WarmupCount; ++i)
+		runTrial(test, numThreads);
+
+	TestMeasurement measurement;
+	measurement.iterations = test.GetIterationCount();
+	test.ResetLatencyHistograms();
+
+	std::vector<double> nanoseconds, cycles;
+	for (int i = 0; i < m_RepetitionCount; ++i) {
+		TimingResult timing = runTrial(test, numThreads, &measurement.counters);
+
+		nanoseconds.push_back(static_cast<double>(timing.nanoseconds));
+		cycles.push_back(static_cast<double>(timing.cycles));
+		LOG_DEBUG(test.GetName() + " trial " + std::to_string(i) + ": " + std::to_string(timing.nanoseconds) + " ns");
+	}
+
+	measurement.stats = Statistics::Compute(nanoseconds);
+	measurement.medianCycles = Statistics::Median(cycles);
+	if (test.IsLatencyRecording())
+		measurement.latency = test.GetLatencyHistogram();
+	return measurement;
 }
 
 void CPUBenchmark::RunAllTests() {
 	LOG_INFO("Starting all benchmark tests");
+
+	m_ReportFile << "Test Name,Score,Score Unit,Iterations,Trials,Min (ns),Median (ns),Mean (ns),StdDev (ns),MAD (ns),"
+		"CI95 Low (ns),CI95 High (ns),CV (%),Outliers,Outlier Trials,Median Cycles,"
+		"IPC,Branch MPKI,L1D MPKI,LLC MPKI,dTLB MPKI,Cycles/Iteration,Work Unit,Work/Iteration,Bandwidth (GB/s),"
+		"ns/Unit,Cycles/Unit,Cycle Source,Latency p50 (ns),Latency p90 (ns),Latency p99 (ns),Latency p99.9 (ns),Latency Max (ns),Placement,CPU Mapping" << std::endl;
+
 	for (const auto& test : m_Tests) {
 		try {
 			LOG_INFO("Running test: " + test->GetName());
 
-			std::chrono::milliseconds duration;
-			if (m_UseMultiThreading)
-				duration = measureExecTime([&]() { test->RunMultiThreaded(m_ThreadCount); });
-			else
-				duration = measureExecTime([&]() { test->Run(); });
+			/* Per-iteration latency is recorded around RunSingleIteration, so even one thread goes through RunMultiThreaded */
+			const int numThreads = m_UseMultiThreading ? m_ThreadCount : (m_RecordLatency ? 1 : 0);
+			TestMeasurement measurement = measureTest(*test, numThreads);
+			const SampleStatistics& stats = measurement.stats;
+			const PerfCounterValues& counters = measurement.counters;
+
+			/* Tests that count no work, or none yet, are scored per iteration */
+			WorkPerIteration work = test->GetWork();
+			if (!(work.amount > 0.0))
+				work = WorkPerIteration();
+			const double units = work.amount * static_cast<double>(measurement.iterations);
 
-			benchmark_float_type score = BENCHMARK_ITERATION_COUNT / static_cast<benchmark_float_type>(duration.count());
+			/* Score from the median, clamped to one nanosecond so a region below timer resolution cannot divide by zero */
+			const double medianNs = std::max(stats.median, 1.0);
+			benchmark_float_type score = units / (medianNs / 1e9) / work.RateScale();
 			test->SetScore(score);
 
-			LOG_INFO(test->GetName() + " completed in " + std::to_string(duration.count()) + " ms");
-			LOG_INFO(test->GetName() + "'s score: " + std::to_string(score) + " iterations/ms");
+			LOG_INFO(test->GetName() + " ran " + std::to_string(measurement.iterations) + " iterations per trial");
+			LOG_INFO(test->GetName() + " median of " + std::to_string(stats.count) + " trials: "
+				+ std::to_string(stats.median) + " ns (" + std::to_string(measurement.medianCycles) + " cycles), CV "
+				+ std::to_string(stats.cv * 100.0) + "%");
+			LOG_INFO(test->GetName() + "'s score: " + std::to_string(score) + " " + work.RateUnit());
+
+			std::string outliers;
+			for (size_t index : stats.outliers)
+				outliers += (outliers.empty() ? "" : ";") + std::to_string(index);
+			if (!outliers.empty())
+				LOG_WARNING(test->GetName() + " has outlier trials: " + outliers);
+
+			double cyclesPerIteration = -1.0;
+			if (counters.Has(PerfEvent::CYCLES))
+				cyclesPerIteration = counters.Get(PerfEvent::CYCLES) / (static_cast<double>(measurement.iterations) * stats.count);
+			const LatencyHistogram& latency = measurement.latency;
+			auto latencyColumn = [&](double percentile) {
+				return latency.GetCount() > 0 ? std::to_string(latency.GetValueAtPercentile(percentile)) : std::string();
+			};
+			if (latency.GetCount() > 0) {
+				LOG_INFO(test->GetName() + " latency over " + std::to_string(latency.GetCount()) + " iterations: p50 "
+					+ latencyColumn(50.0) + " ns, p99 " + latencyColumn(99.0) + " ns, p99.9 " + latencyColumn(99.9)
+					+ " ns, max " + latencyColumn(100.0) + " ns");
+			}
+
+			/* Bytes per nanosecond is GB/s */
+			std::string bandwidth;
+			if (work.bytes > 0.0) {
+				bandwidth = std::to_string(work.bytes * measurement.iterations / medianNs);
+				LOG_INFO(test->GetName() + " effective bandwidth: " + bandwidth + " GB/s");
+			}
+
+			/*
+			 * Wall time per unit, so with several threads it is the inverse of the combined rate. Core cycles
+			 * from the PMU are summed over the threads, i.e. per unit on one core; without them the reference
+			 * cycles of the median trial stand in when the TSC frequency is known.
+			 */
+			const double nsPerUnit = medianNs / units;
+			double cyclesPerUnit = -1.0;
+			std::string cycleSource;
+			if (counters.Has(PerfEvent::CYCLES)) {
+				cyclesPerUnit = counters.Get(PerfEvent::CYCLES) / (units * stats.count);
+				cycleSource = "core";
+			}
+			else if (Timer::GetTscFrequencyHz() > 0.0) {
+				cyclesPerUnit = nsPerUnit * Timer::GetTscFrequencyHz() / 1e9;
+				cycleSource = "tsc";
+			}
+			LOG_INFO(test->GetName() + " per " + work.UnitName() + ": " + std::to_string(nsPerUnit) + " ns"
+				+ (cyclesPerUnit >= 0.0 ? ", " + formatMetric(cyclesPerUnit) + " " + cycleSource + " cycles" : std::string()));
+
+			if (m_UsePerfCounters) {
+				LOG_INFO(test->GetName() + " IPC: " + formatMetric(counters.Ipc())
+					+ ", LLC MPKI: " + formatMetric(counters.MissesPerKiloInstruction(PerfEvent::LLC_MISSES))
+					+ ", cycles/iteration: " + formatMetric(cyclesPerIteration));
+			}
 		
-			m_ReportFile << test->GetName() << "," << score << "," << duration.count() << std::endl;
+			m_ReportFile << test->GetName() << "," << score << "," << work.RateUnit() << "," << measurement.iterations << "," << stats.count << ","
+				<< stats.min << "," << stats.median << "," << stats.mean << "," << stats.stddev << ","
+				<< stats.mad << "," << stats.ciLow << "," << stats.ciHigh << "," << stats.cv * 100.0 << ","
+				<< stats.outliers.size() << "," << outliers << "," << measurement.medianCycles << ","
+				<< formatMetric(counters.Ipc()) << ","
+				<< formatMetric(counters.MissesPerKiloInstruction(PerfEvent::BRANCH_MISSES)) << ","
+				<< formatMetric(counters.MissesPerKiloInstruction(PerfEvent::L1D_MISSES)) << ","
+				<< formatMetric(counters.MissesPerKiloInstruction(PerfEvent::LLC_MISSES)) << ","
+				<< formatMetric(counters.MissesPerKiloInstruction(PerfEvent::DTLB_MISSES)) << ","
+				<< formatMetric(cyclesPerIteration) << ","
+				<< work.UnitName() << "," << work.amount << "," << bandwidth << ","
+				<< std::to_string(nsPerUnit) << "," << formatMetric(cyclesPerUnit) << "," << cycleSource << ","
+				<< latencyColumn(50.0) << "," << latencyColumn(90.0) << "," << latencyColumn(99.0) << ","
+				<< latencyColumn(99.9) << "," << latencyColumn(100.0) << ","
+				<< ThreadPlacement::PlacementPolicyToString(m_Placement) << ","
+				<< ThreadPlacement::MappingToString(m_CpuMapping) << std::endl;
 		}
 		catch (const BenchmarkException& e) {
 			std::cerr << "Error in test " << test->GetName() << ": " << e.what() << std::endl;
@@ -91,4 +388,206 @@ void CPUBenchmark::RunAllTests() {
 		}
 	}
 	LOG_INFO("All benchmark tests completed");
-}
\ No newline at end of file
+}
+
+void CPUBenchmark::RunScalingSweep() {
+	LOG_INFO("Starting thread-scaling sweep over " + std::to_string(m_ScalingThreads.size()) + " thread counts");
+
+	m_ReportFile << "Test Name,Threads,Iterations,Median (ns),CV (%),Throughput,Throughput Unit,Speedup,"
+		"Parallel Efficiency,Amdahl Serial Fraction,CPU Mapping" << std::endl;
+
+	for (const auto& test : m_Tests) {
+		try {
+			LOG_INFO("Scaling test: " + test->GetName());
+
+			/* Every point goes through RunMultiThreaded, even one thread, so all points run the same code */
+			/* Throughput in the test's own work units, the same rate RunAllTests scores it in */
+			std::vector<double> throughputs;
+			std::vector<TestMeasurement> measurements;
+			WorkPerIteration work;
+			for (int threads : m_ScalingThreads) {
+				measurements.push_back(measureTest(*test, threads));
+				const TestMeasurement& measurement = measurements.back();
+				work = test->GetWork();
+				if (!(work.amount > 0.0))
+					work = WorkPerIteration();
+				throughputs.push_back(work.amount * measurement.iterations / (std::max(measurement.stats.median, 1.0) / 1e9) / work.RateScale());
+				LOG_INFO(test->GetName() + " with " + std::to_string(threads) + " threads: "
+					+ std::to_string(throughputs.back()) + " " + work.RateUnit());
+			}
+
+			/* Speedup is relative to the first point, which is assumed to scale perfectly if it is not one thread */
+			std::vector<double> speedups;
+			for (double throughput : throughputs)
+				speedups.push_back(throughput * m_ScalingThreads.front() / std::max(throughputs.front(), 1e-9));
+
+			/*
+			 * Amdahl: 1/S(p) = s + (1 - s)/p. With x = 1 - 1/p and y = 1/S - 1/p this is y = s * x,
+			 * so the least-squares serial fraction is sum(x * y) / sum(x * x) over the points with p > 1.
+			 */
+			double sumXY = 0.0, sumXX = 0.0;
+			for (size_t i = 0; i < m_ScalingThreads.size(); ++i) {
+				const double p = m_ScalingThreads[i];
+				if (p <= 1.0 || speedups[i] <= 0.0)
+					continue;
+				const double x = 1.0 - 1.0 / p;
+				const double y = 1.0 / speedups[i] - 1.0 / p;
+				sumXY += x * y;
+				sumXX += x * x;
+			}
+			const double serialFraction = sumXX > 0.0 ? std::clamp(sumXY / sumXX, 0.0, 1.0) : -1.0;
+			LOG_INFO(test->GetName() + " Amdahl serial fraction: " + formatMetric(serialFraction));
+
+			for (size_t i = 0; i < m_ScalingThreads.size(); ++i) {
+				const int threads = m_ScalingThreads[i];
+				const std::vector<int> mapping = m_CpuMapping.empty()
+					? std::vector<int>{}
+					: std::vector<int>(m_CpuMapping.begin(), m_CpuMapping.begin() + threads);
+
+				m_ReportFile << test->GetName() << "," << threads << "," << measurements[i].iterations << ","
+					<< measurements[i].stats.median << "," << measurements[i].stats.cv * 100.0 << ","
+					<< throughputs[i] << "," << work.RateUnit() << "," << speedups[i] << "," << speedups[i] / threads << ","
+					<< formatMetric(serialFraction) << "," << ThreadPlacement::MappingToString(mapping) << std::endl;
+			}
+		}
+		catch (const BenchmarkException& e) {
+			std::cerr << "Error in test " << test->GetName() << ": " << e.what() << std::endl;
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Unexpected error in test " << test->GetName() << ": " << e.what() << std::endl;
+		}
+	}
+	LOG_INFO("Thread-scaling sweep completed");
+}
+
+void CPUBenchmark::RunLoadSweep() {
+	LOG_INFO("Starting open-loop load sweep over " + std::to_string(m_LoadRates.size()) + " rates");
+
+	m_ReportFile << "Test Name,Arrival,Threads,Target Rate (requests/s),Achieved Rate (requests/s),Requests,"
+		"Latency p50 (ns),Latency p90 (ns),Latency p99 (ns),Latency p99.9 (ns),Latency Max (ns)" << std::endl;
+
+	for (const auto& test : m_Tests) {
+		try {
+			LOG_INFO("Load testing: " + test->GetName());
+
+			test->SetUp();
+			test->SetUpOpenLoop(m_ThreadCount);
+			for (double rate : m_LoadRates) {
+				const int64_t requests = std::max<int64_t>(1, static_cast<int64_t>(rate * m_LoadDurationMs / 1000.0));
+
+				/* A shortened untimed pass at the same rate warms caches and the frequency governor */
+				for (int i = 0; i < m_WarmupCount; ++i) {
+					test->ResetTrial();
+					test->RunOpenLoop(m_ThreadCount, rate, m_Arrival, std::max<int64_t>(1, requests / 10));
+				}
+				test->ResetLatencyHistograms();
+				test->ResetTrial();
+
+				const int64_t elapsedNs = test->RunOpenLoop(m_ThreadCount, rate, m_Arrival, requests);
+				const double achievedRate = requests / (std::max<int64_t>(elapsedNs, 1) / 1e9);
+				const LatencyHistogram latency = test->GetLatencyHistogram();
+				test->ResetLatencyHistograms();
+
+				LOG_INFO(test->GetName() + " at " + std::to_string(rate) + " requests/s: achieved "
+					+ std::to_string(achievedRate) + " requests/s, p99 " + std::to_string(latency.GetValueAtPercentile(99.0)) + " ns");
+
+				m_ReportFile << test->GetName() << "," << ArrivalSchedule::ArrivalProcessToString(m_Arrival) << ","
+					<< m_ThreadCount << "," << rate << "," << achievedRate << "," << requests << ","
+					<< latency.GetValueAtPercentile(50.0) << "," << latency.GetValueAtPercentile(90.0) << ","
+					<< latency.GetValueAtPercentile(99.0) << "," << latency.GetValueAtPercentile(99.9) << ","
+					<< latency.GetMax() << std::endl;
+			}
+
+			/* Open-loop requests write per-thread results, so one untimed closed-loop product gives Verify something to check */
+			test->SetIterationCount(1);
+			test->ResetTrial();
+			test->Run();
+			verifyTest(*test);
+			test->TearDown();
+		}
+		catch (const BenchmarkException& e) {
+			test->TearDown();
+			std::cerr << "Error in test " << test->GetName() << ": " << e.what() << std::endl;
+		}
+		catch (const std::exception& e) {
+			test->TearDown();
+			std::cerr << "Unexpected error in test " << test->GetName() << ": " << e.what() << std::endl;
+		}
+	}
+	LOG_INFO("Open-loop load sweep completed");
+}
+
+void CPUBenchmark::RunMatrixSweep() {
+	LOG_INFO("Starting matrix size sweep over " + std::to_string(m_MatrixSizes.size()) + " sizes");
+
+	const int numThreads = m_UseMultiThreading ? m_ThreadCount : 0;
+	const RooflineCeilings ceilings = Roofline::Measure(m_Pool.get(), std::max(numThreads, 1));
+
+	m_ReportFile << "Threads,SIMD ISA,Peak (GFLOP/s),Triad Bandwidth (GB/s),Ridge Point (FLOP/byte)" << std::endl;
+	m_ReportFile << std::max(numThreads, 1) << "," << IsaDispatch::IsaToString(IsaDispatch::GetActive()) << "," << ceilings.peakGflops << "," << ceilings.bandwidthGBs << ","
+		<< ceilings.RidgePoint() << std::endl;
+	m_ReportFile << std::endl;
+
+	m_ReportFile << "Test Name,Size,Iterations,Trials,Median (ns),CV (%),Throughput,Throughput Unit,Arithmetic Intensity (FLOP/byte),"
+		"Attainable (GFLOP/s),Roofline Efficiency (%),Bound,Max Relative Error,CPU Mapping" << std::endl;
+
+	/*
+	 * The compute roof is the FP32 FMA peak, so the other precisions are rated against it too.
+	 * Throughput is in the test's own unit, GFLOP/s or GOP/s, which share the 1e9 scale of the roof.
+	 */
+	auto sweepPoint = [&](BenchmarkTest& test, int size) {
+		try {
+			configureTest(test);
+			const TestMeasurement measurement = measureTest(test, numThreads);
+			const double seconds = std::max(measurement.stats.median, 1.0) / 1e9;
+			const WorkPerIteration work = test.GetWork();
+			const double throughput = work.amount * measurement.iterations / seconds / work.RateScale();
+
+			/* Compulsory traffic only: A and B read once, C written once */
+			const double intensity = work.amount / std::max(work.bytes, 1.0);
+			const double attainable = ceilings.AttainableGflops(intensity);
+
+			/* Strassen is scored on the classical op count, so it can beat the roofline; its error shows the price */
+			std::string error;
+			if (const auto* strassen = dynamic_cast<const StrassenMultiplicationTest*>(&test)) {
+				std::ostringstream oss;
+				oss << std::scientific << std::setprecision(3) << strassen->GetMaxRelativeError();
+				error = oss.str();
+			}
+
+			LOG_INFO(test.GetName() + " at size " + std::to_string(size) + ": " + std::to_string(throughput) + " " + work.RateUnit() + ", "
+				+ std::to_string(throughput / std::max(attainable, 1e-9) * 100.0) + "% of the roofline");
+
+			m_ReportFile << test.GetName() << "," << size << "," << measurement.iterations << ","
+				<< measurement.stats.count << "," << measurement.stats.median << "," << measurement.stats.cv * 100.0 << ","
+				<< throughput << "," << work.RateUnit() << "," << intensity << "," << attainable << "," << throughput / std::max(attainable, 1e-9) * 100.0 << ","
+				<< (intensity < ceilings.RidgePoint() ? "memory" : "compute") << "," << error << ","
+				<< ThreadPlacement::MappingToString(m_CpuMapping) << std::endl;
+		}
+		catch (const BenchmarkException& e) {
+			std::cerr << "Error in test " << test.GetName() << " at size " << size << ": " << e.what() << std::endl;
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Unexpected error in test " << test.GetName() << " at size " << size << ": " << e.what() << std::endl;
+		}
+	};
+
+	/* The enabled tests only stand for their registry entries here, every point builds a fresh instance at its size */
+	for (int size : m_MatrixSizes) {
+		TestParams params = m_TestParams;
+		params.matrixSize = static_cast<size_t>(size);
+		params.explicitParams |= TEST_PARAM_MATRIX_SIZE;
+
+		for (const auto& enabled : m_Tests) {
+			std::unique_ptr<BenchmarkTest> test = TestRegistry::Create(enabled->GetName(), params);
+			if (test == nullptr)
+				continue;
+
+			/* Below this size Strassen recurses too little to differ from the classical product */
+			if (dynamic_cast<const StrassenMultiplicationTest*>(test.get()) != nullptr && size < STRASSEN_MIN_SIZE)
+				continue;
+			sweepPoint(*test, size);
+		}
+	}
+	LOG_INFO("Matrix size sweep completed");
+}
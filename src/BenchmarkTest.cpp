@@ -1,35 +1,58 @@
-#include <vector>
-#include <thread>
-#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
 #include "BenchmarkTest.hpp"
 #include "Logger.hpp"
+#include "Timer.hpp"
 
 BenchmarkTest::BenchmarkTest(const std::string& testName) {
 	m_Name = testName;
 	m_Score = 0.0;
 }
 
+void BenchmarkTest::SetUp() {}
+
+void BenchmarkTest::ResetTrial() {}
+
+void BenchmarkTest::SetUpOpenLoop(int) {}
+
+void BenchmarkTest::Verify() {}
+
+void BenchmarkTest::TearDown() {}
+
 void BenchmarkTest::RunMultiThreaded(int numThreads) {
-	LOG_INFO("Starting multi-threaded run of " + m_Name + " with " + std::to_string(numThreads) + " threads");
+	/* Runs inside the timed region, so no logging here; the harness reports the schedule */
+	WorkScheduler scheduler(m_ScheduleMode, m_IterationCount, numThreads, m_ChunkSize);
 
-	std::vector<std::thread> threads;
-	std::atomic<int> counter(0);
+	if (m_RecordLatency)
+		PrepareLatencyHistograms(numThreads);
+	if (static_cast<int>(m_ThreadContexts.size()) < numThreads)
+		PrepareThreadContexts(numThreads);
 
-	for (int i = 0; i < numThreads; ++i) {
-		threads.emplace_back([this, &counter, numThreads, i]() {
-			LOG_DEBUG("Thread " + std::to_string(i) + " started for " + m_Name);
-			while (counter.fetch_add(1) < BENCHMARK_ITERATION_COUNT) {
-				this->RunSingleIteration();
+	RunOnThreads(numThreads, [this, &scheduler](int i) {
+		ThreadContext& context = m_ThreadContexts[i];
+		int64_t begin, end;
+		if (m_RecordLatency) {
+			LatencyHistogram& histogram = m_LatencyHistograms[i];
+			while (scheduler.NextChunk(i, begin, end)) {
+				for (int64_t iter = begin; iter < end; ++iter) {
+					const Timer::Stamp start = Timer::Start();
+					this->RunSingleIteration(context);
+					histogram.Record(Timer::Elapsed(start, Timer::Stop()).nanoseconds);
+				}
 			}
-			LOG_DEBUG("Thread " + std::to_string(i) + " finished for " + m_Name);
-		});
-	}
-	for (auto& thread : threads) {
-		thread.join();
-	}
-	
-	LOG_INFO("Completed multi-threaded run of " + m_Name);
+		}
+		else {
+			while (scheduler.NextChunk(i, begin, end))
+				this->RunIterations(begin, end, context);
+		}
+	});
+}
+
+void BenchmarkTest::RunIterations(int64_t begin, int64_t end, ThreadContext& context) {
+	for (int64_t iter = begin; iter < end; ++iter)
+		RunSingleIteration(context);
 }
 
 std::string BenchmarkTest::GetName() const {
@@ -43,3 +66,179 @@ void BenchmarkTest::SetScore(benchmark_float_type score) {
 benchmark_float_type BenchmarkTest::GetScore() const {
 	return m_Score;
 }
+
+void BenchmarkTest::SetSchedule(ScheduleMode mode, int64_t chunkSize) {
+	m_ScheduleMode = mode;
+	m_ChunkSize = chunkSize;
+}
+
+void BenchmarkTest::SetIterationCount(int64_t iterationCount) {
+	m_IterationCount = iterationCount;
+}
+
+int64_t BenchmarkTest::GetIterationCount() const {
+	return m_IterationCount;
+}
+
+void BenchmarkTest::SetThreadPool(ThreadPool* pool) {
+	m_Pool = pool;
+}
+
+void BenchmarkTest::SetSeed(uint64_t seed) {
+	m_Seed = seed;
+}
+
+uint64_t BenchmarkTest::GetSeed() const {
+	return m_Seed;
+}
+
+ThreadContext BenchmarkTest::CreateThreadContext(int threadIndex) const {
+	ThreadContext context;
+	context.threadIndex = threadIndex;
+	context.random = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM + 1 + static_cast<uint64_t>(threadIndex));
+	return context;
+}
+
+ThreadContext& BenchmarkTest::GetThreadContext(int threadIndex) {
+	if (static_cast<int>(m_ThreadContexts.size()) <= threadIndex)
+		PrepareThreadContexts(threadIndex + 1);
+	return m_ThreadContexts[threadIndex];
+}
+
+void BenchmarkTest::PrepareThreadContexts(int numThreads) {
+	m_ThreadContexts.clear();
+	for (int i = 0; i < numThreads; i++)
+		m_ThreadContexts.push_back(CreateThreadContext(i));
+}
+
+bool BenchmarkTest::NearlyEqual(double actual, double expected, double tolerance) {
+	return std::abs(actual - expected) <= tolerance;
+}
+
+void BenchmarkTest::ExpectNear(const std::string& what, double actual, double expected, double tolerance) const {
+	if (NearlyEqual(actual, expected, tolerance))
+		return;
+
+	const std::string message = m_Name + " verification failed: " + what + " is " + std::to_string(actual)
+		+ ", expected " + std::to_string(expected) + " within " + std::to_string(tolerance);
+	LOG_ERROR(message);
+	throw VerificationException(message);
+}
+
+void BenchmarkTest::ExpectEqual(const std::string& what, int64_t actual, int64_t expected) const {
+	if (actual == expected)
+		return;
+
+	const std::string message = m_Name + " verification failed: " + what + " is " + std::to_string(actual)
+		+ ", expected " + std::to_string(expected);
+	LOG_ERROR(message);
+	throw VerificationException(message);
+}
+
+WorkPerIteration BenchmarkTest::GetWork() const {
+	return WorkPerIteration();
+}
+
+std::string WorkPerIteration::UnitName() const {
+	switch (unit) {
+	case WorkUnit::ITERATION:	return "iteration";
+	case WorkUnit::FLOP:		return "flop";
+	case WorkUnit::INT_OP:		return "int op";
+	case WorkUnit::ITEM:		return itemName;
+	default:					return "unknown";
+	}
+}
+
+std::string WorkPerIteration::RateUnit() const {
+	switch (unit) {
+	case WorkUnit::ITERATION:	return "iterations/ms";
+	case WorkUnit::FLOP:		return "GFLOP/s";
+	case WorkUnit::INT_OP:		return "GOP/s";
+	case WorkUnit::ITEM:		return "Mitems/s";
+	default:					return "unknown";
+	}
+}
+
+double WorkPerIteration::RateScale() const {
+	switch (unit) {
+	case WorkUnit::ITERATION:	return 1e3;
+	case WorkUnit::FLOP:		return 1e9;
+	case WorkUnit::INT_OP:		return 1e9;
+	case WorkUnit::ITEM:		return 1e6;
+	default:					return 1.0;
+	}
+}
+
+void BenchmarkTest::RunOnThreads(int numThreads, const ThreadPool::Job& job) {
+	if (m_Pool != nullptr && m_Pool->GetSize() >= numThreads) {
+		m_Pool->Run(numThreads, job);
+		return;
+	}
+
+	LOG_WARNING("No shared thread pool large enough for " + m_Name + ", creating a temporary one");
+	ThreadPool pool(numThreads);
+	pool.Run(job);
+}
+
+void BenchmarkTest::SetLatencyRecording(bool enabled) {
+	m_RecordLatency = enabled;
+}
+
+bool BenchmarkTest::IsLatencyRecording() const {
+	return m_RecordLatency;
+}
+
+void BenchmarkTest::PrepareLatencyHistograms(int numThreads) {
+	if (static_cast<int>(m_LatencyHistograms.size()) < numThreads)
+		m_LatencyHistograms.resize(numThreads);
+}
+
+void BenchmarkTest::ResetLatencyHistograms() {
+	for (LatencyHistogram& histogram : m_LatencyHistograms)
+		histogram.Reset();
+}
+
+LatencyHistogram BenchmarkTest::GetLatencyHistogram() const {
+	LatencyHistogram merged;
+	for (const LatencyHistogram& histogram : m_LatencyHistograms)
+		merged.Merge(histogram);
+	return merged;
+}
+
+int64_t BenchmarkTest::RunOpenLoop(int numThreads, double requestsPerSecond, ArrivalProcess arrival, int64_t totalRequests) {
+	LOG_INFO("Starting open-loop run of " + m_Name + " at " + std::to_string(requestsPerSecond) + " requests/s ("
+		+ ArrivalSchedule::ArrivalProcessToString(arrival) + " arrivals) on " + std::to_string(numThreads) + " threads");
+
+	PrepareLatencyHistograms(numThreads);
+	PrepareThreadContexts(numThreads);
+	std::vector<int64_t> finishNs(numThreads, 0);
+
+	/* Arrival streams come from the run seed like the thread contexts, under a seed of their own so they do not repeat them */
+	std::vector<Xoshiro256> arrivalStreams;
+	for (int i = 0; i < numThreads; i++)
+		arrivalStreams.push_back(Xoshiro256::Stream(m_Seed ^ OPEN_LOOP_SEED, static_cast<uint64_t>(i)));
+
+	/* Start in the future so every worker is awake before its first arrival, then interleave the threads */
+	const double intervalNs = 1e9 / requestsPerSecond;
+	const int64_t startNs = Timer::NowNs() + OPEN_LOOP_START_DELAY_NS;
+
+	RunOnThreads(numThreads, [&](int i) {
+		const int64_t requests = totalRequests * (i + 1) / numThreads - totalRequests * i / numThreads;
+		ArrivalSchedule schedule(arrival, requestsPerSecond / numThreads,
+			startNs + static_cast<int64_t>(intervalNs * i), arrivalStreams[i]);
+		LatencyHistogram& histogram = m_LatencyHistograms[i];
+		ThreadContext& context = m_ThreadContexts[i];
+
+		int64_t end = startNs;
+		for (int64_t r = 0; r < requests; ++r) {
+			const int64_t intended = schedule.Next();
+			ArrivalSchedule::WaitUntil(intended);
+			this->RunSingleIteration(context);
+			end = Timer::NowNs();
+			histogram.Record(end - intended);
+		}
+		finishNs[i] = end;
+	});
+
+	return *std::max_element(finishNs.begin(), finishNs.end()) - startNs;
+}
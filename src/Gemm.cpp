@@ -0,0 +1,966 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Gemm.hpp"
+#include "Logger.hpp"
+
+namespace {
+	/* Packing buffers are kept per thread and only ever grow, so small products do not pay for allocation */
+	template<typename T>
+	T* PackingBuffer(Matrix<T>& buffer, size_t count) {
+		if (buffer.Cols() < count)
+			buffer = Matrix<T>(1, count);
+		return buffer.Data();
+	}
+
+	template<typename PA, typename PB>
+	struct ThreadPackingBuffers {
+		Matrix<PA> a;
+		Matrix<PB> b;
+	};
+
+	template<typename PA, typename PB>
+	ThreadPackingBuffers<PA, PB>& GetThreadPackingBuffers() {
+		thread_local ThreadPackingBuffers<PA, PB> buffers;
+		return buffers;
+	}
+
+	/* Converts an operand element into the type it is packed as */
+	template<typename P, typename T>
+	inline P PackValue(T value) {
+		return static_cast<P>(value);
+	}
+
+	template<>
+	inline float PackValue<float, Float16>(Float16 value) {
+		return ToFloat(value);
+	}
+
+	/* Converts one row of B into its packed type */
+	template<typename P, typename T>
+	void PackRow(const T* row, size_t count, P* packed) {
+		for (size_t j = 0; j < count; j++)
+			packed[j] = PackValue<P>(row[j]);
+	}
+
+#if BENCHMARK_X86
+	TARGET_F16C void PackRowF16C(const Float16* row, size_t count, float* packed) {
+		size_t j = 0;
+		for (; j + 8 <= count; j += 8)
+			_mm256_storeu_ps(packed + j, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j))));
+		for (; j < count; j++)
+			packed[j] = ToFloat(row[j]);
+	}
+#endif
+
+	template<>
+	void PackRow<float, Float16>(const Float16* row, size_t count, float* packed) {
+#if BENCHMARK_X86
+		/* Eight halves per instruction, as long as the user has not restricted the ISA below AVX */
+		static const bool f16c = IsaDispatch::HasFeature(CpuFeature::F16C);
+		if (f16c && IsaDispatch::GetActive() >= SimdIsa::AVX2_FMA) {
+			PackRowF16C(row, count, packed);
+			return;
+		}
+#endif
+		for (size_t j = 0; j < count; j++)
+			packed[j] = ToFloat(row[j]);
+	}
+
+	/* Widens a packed element to the accumulator type of the scalar kernel */
+	template<typename T>
+	inline T Widen(T value) {
+		return value;
+	}
+
+	inline float Widen(BFloat16 value) {
+		return ToFloat(value);
+	}
+
+	inline int32_t Widen(uint8_t value) {
+		return value;
+	}
+
+	inline int32_t Widen(int8_t value) {
+		return value;
+	}
+
+	/* One K group of a packed A panel as a 32-bit broadcast value, BF16 pairs and INT8 quads alike */
+	inline int32_t LoadGroup(const void* group) {
+		int32_t value;
+		std::memcpy(&value, group, sizeof(value));
+		return value;
+	}
+
+	/* Portable reference for every element type; the inner loop is plain enough for the compiler to vectorize */
+	template<typename PA, typename PB, typename TC, size_t NR, size_t K_GROUP>
+	void MicroKernelScalar(size_t groups, const PA* packedA, const PB* packedB, TC* c, size_t ldc, bool accumulate) {
+		TC tile[GEMM_MR][NR] = {};
+		for (size_t p = 0; p < groups; p++) {
+			for (size_t i = 0; i < GEMM_MR; i++) {
+				for (size_t q = 0; q < K_GROUP; q++) {
+					const TC a = Widen(packedA[i * K_GROUP + q]);
+					for (size_t j = 0; j < NR; j++)
+						tile[i][j] += a * Widen(packedB[j * K_GROUP + q]);
+				}
+			}
+			packedA += GEMM_MR * K_GROUP;
+			packedB += NR * K_GROUP;
+		}
+
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			TC* row = c + i * ldc;
+			for (size_t j = 0; j < NR; j++)
+				row[j] = accumulate ? row[j] + tile[i][j] : tile[i][j];
+		}
+	}
+
+#if BENCHMARK_X86
+	/* Two passes over 8 columns each, twelve accumulators per pass fit the sixteen xmm registers */
+	TARGET_SSE42 void MicroKernelSSE42(size_t depth, const float* packedA, const float* packedB, float* c, size_t ldc, bool accumulate) {
+		for (size_t half = 0; half < 2; half++) {
+			__m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+			__m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+			__m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+			__m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+			__m128 c40 = _mm_setzero_ps(), c41 = _mm_setzero_ps();
+			__m128 c50 = _mm_setzero_ps(), c51 = _mm_setzero_ps();
+
+			const float* pa = packedA;
+			const float* pb = packedB + half * 8;
+			for (size_t p = 0; p < depth; p++) {
+				const __m128 b0 = _mm_load_ps(pb);
+				const __m128 b1 = _mm_load_ps(pb + 4);
+				__m128 a;
+
+				a = _mm_set1_ps(pa[0]);
+				c00 = _mm_add_ps(c00, _mm_mul_ps(a, b0)); c01 = _mm_add_ps(c01, _mm_mul_ps(a, b1));
+				a = _mm_set1_ps(pa[1]);
+				c10 = _mm_add_ps(c10, _mm_mul_ps(a, b0)); c11 = _mm_add_ps(c11, _mm_mul_ps(a, b1));
+				a = _mm_set1_ps(pa[2]);
+				c20 = _mm_add_ps(c20, _mm_mul_ps(a, b0)); c21 = _mm_add_ps(c21, _mm_mul_ps(a, b1));
+				a = _mm_set1_ps(pa[3]);
+				c30 = _mm_add_ps(c30, _mm_mul_ps(a, b0)); c31 = _mm_add_ps(c31, _mm_mul_ps(a, b1));
+				a = _mm_set1_ps(pa[4]);
+				c40 = _mm_add_ps(c40, _mm_mul_ps(a, b0)); c41 = _mm_add_ps(c41, _mm_mul_ps(a, b1));
+				a = _mm_set1_ps(pa[5]);
+				c50 = _mm_add_ps(c50, _mm_mul_ps(a, b0)); c51 = _mm_add_ps(c51, _mm_mul_ps(a, b1));
+
+				pa += GEMM_MR;
+				pb += 16;
+			}
+
+			const __m128 rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+			for (size_t i = 0; i < GEMM_MR; i++) {
+				float* row = c + i * ldc + half * 8;
+				__m128 lo = rows[i][0];
+				__m128 hi = rows[i][1];
+				if (accumulate) {
+					lo = _mm_add_ps(lo, _mm_loadu_ps(row));
+					hi = _mm_add_ps(hi, _mm_loadu_ps(row + 4));
+				}
+				_mm_storeu_ps(row, lo);
+				_mm_storeu_ps(row + 4, hi);
+			}
+		}
+	}
+
+	/* Twelve accumulators, two B vectors and one broadcast A value fill all 16 ymm registers */
+	TARGET_AVX2_FMA void MicroKernelAVX2(size_t depth, const float* packedA, const float* packedB, float* c, size_t ldc, bool accumulate) {
+		__m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+		__m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+		__m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+		__m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+		__m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+		__m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+		for (size_t p = 0; p < depth; p++) {
+			const __m256 b0 = _mm256_load_ps(packedB);
+			const __m256 b1 = _mm256_load_ps(packedB + 8);
+			__m256 a;
+
+			a = _mm256_broadcast_ss(packedA + 0);
+			c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+			a = _mm256_broadcast_ss(packedA + 1);
+			c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+			a = _mm256_broadcast_ss(packedA + 2);
+			c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+			a = _mm256_broadcast_ss(packedA + 3);
+			c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+			a = _mm256_broadcast_ss(packedA + 4);
+			c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+			a = _mm256_broadcast_ss(packedA + 5);
+			c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+
+			packedA += GEMM_MR;
+			packedB += 16;
+		}
+
+		const __m256 rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			float* row = c + i * ldc;
+			__m256 lo = rows[i][0];
+			__m256 hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm256_add_ps(lo, _mm256_loadu_ps(row));
+				hi = _mm256_add_ps(hi, _mm256_loadu_ps(row + 8));
+			}
+			_mm256_storeu_ps(row, lo);
+			_mm256_storeu_ps(row + 8, hi);
+		}
+	}
+
+	/* Same shape as the AVX2 kernel with 16-float vectors, so the tile is 6x32 and uses 12 of the 32 zmm registers */
+	TARGET_AVX512F void MicroKernelAVX512(size_t depth, const float* packedA, const float* packedB, float* c, size_t ldc, bool accumulate) {
+		__m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+		__m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+		__m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+		__m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+		__m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+		__m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+
+		for (size_t p = 0; p < depth; p++) {
+			const __m512 b0 = _mm512_load_ps(packedB);
+			const __m512 b1 = _mm512_load_ps(packedB + 16);
+			__m512 a;
+
+			a = _mm512_set1_ps(packedA[0]);
+			c00 = _mm512_fmadd_ps(a, b0, c00); c01 = _mm512_fmadd_ps(a, b1, c01);
+			a = _mm512_set1_ps(packedA[1]);
+			c10 = _mm512_fmadd_ps(a, b0, c10); c11 = _mm512_fmadd_ps(a, b1, c11);
+			a = _mm512_set1_ps(packedA[2]);
+			c20 = _mm512_fmadd_ps(a, b0, c20); c21 = _mm512_fmadd_ps(a, b1, c21);
+			a = _mm512_set1_ps(packedA[3]);
+			c30 = _mm512_fmadd_ps(a, b0, c30); c31 = _mm512_fmadd_ps(a, b1, c31);
+			a = _mm512_set1_ps(packedA[4]);
+			c40 = _mm512_fmadd_ps(a, b0, c40); c41 = _mm512_fmadd_ps(a, b1, c41);
+			a = _mm512_set1_ps(packedA[5]);
+			c50 = _mm512_fmadd_ps(a, b0, c50); c51 = _mm512_fmadd_ps(a, b1, c51);
+
+			packedA += GEMM_MR;
+			packedB += 32;
+		}
+
+		const __m512 rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			float* row = c + i * ldc;
+			__m512 lo = rows[i][0];
+			__m512 hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm512_add_ps(lo, _mm512_loadu_ps(row));
+				hi = _mm512_add_ps(hi, _mm512_loadu_ps(row + 16));
+			}
+			_mm512_storeu_ps(row, lo);
+			_mm512_storeu_ps(row + 16, hi);
+		}
+	}
+
+	/* FP64 versions of the FP32 kernels, half as many columns per vector */
+	TARGET_AVX2_FMA void MicroKernelFP64AVX2(size_t depth, const double* packedA, const double* packedB, double* c, size_t ldc, bool accumulate) {
+		__m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+		__m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+		__m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+		__m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+		__m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+		__m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+		for (size_t p = 0; p < depth; p++) {
+			const __m256d b0 = _mm256_load_pd(packedB);
+			const __m256d b1 = _mm256_load_pd(packedB + 4);
+			__m256d a;
+
+			a = _mm256_broadcast_sd(packedA + 0);
+			c00 = _mm256_fmadd_pd(a, b0, c00); c01 = _mm256_fmadd_pd(a, b1, c01);
+			a = _mm256_broadcast_sd(packedA + 1);
+			c10 = _mm256_fmadd_pd(a, b0, c10); c11 = _mm256_fmadd_pd(a, b1, c11);
+			a = _mm256_broadcast_sd(packedA + 2);
+			c20 = _mm256_fmadd_pd(a, b0, c20); c21 = _mm256_fmadd_pd(a, b1, c21);
+			a = _mm256_broadcast_sd(packedA + 3);
+			c30 = _mm256_fmadd_pd(a, b0, c30); c31 = _mm256_fmadd_pd(a, b1, c31);
+			a = _mm256_broadcast_sd(packedA + 4);
+			c40 = _mm256_fmadd_pd(a, b0, c40); c41 = _mm256_fmadd_pd(a, b1, c41);
+			a = _mm256_broadcast_sd(packedA + 5);
+			c50 = _mm256_fmadd_pd(a, b0, c50); c51 = _mm256_fmadd_pd(a, b1, c51);
+
+			packedA += GEMM_MR;
+			packedB += 8;
+		}
+
+		const __m256d rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			double* row = c + i * ldc;
+			__m256d lo = rows[i][0];
+			__m256d hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm256_add_pd(lo, _mm256_loadu_pd(row));
+				hi = _mm256_add_pd(hi, _mm256_loadu_pd(row + 4));
+			}
+			_mm256_storeu_pd(row, lo);
+			_mm256_storeu_pd(row + 4, hi);
+		}
+	}
+
+	TARGET_AVX512F void MicroKernelFP64AVX512(size_t depth, const double* packedA, const double* packedB, double* c, size_t ldc, bool accumulate) {
+		__m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+		__m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+		__m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+		__m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+		__m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd();
+		__m512d c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+
+		for (size_t p = 0; p < depth; p++) {
+			const __m512d b0 = _mm512_load_pd(packedB);
+			const __m512d b1 = _mm512_load_pd(packedB + 8);
+			__m512d a;
+
+			a = _mm512_set1_pd(packedA[0]);
+			c00 = _mm512_fmadd_pd(a, b0, c00); c01 = _mm512_fmadd_pd(a, b1, c01);
+			a = _mm512_set1_pd(packedA[1]);
+			c10 = _mm512_fmadd_pd(a, b0, c10); c11 = _mm512_fmadd_pd(a, b1, c11);
+			a = _mm512_set1_pd(packedA[2]);
+			c20 = _mm512_fmadd_pd(a, b0, c20); c21 = _mm512_fmadd_pd(a, b1, c21);
+			a = _mm512_set1_pd(packedA[3]);
+			c30 = _mm512_fmadd_pd(a, b0, c30); c31 = _mm512_fmadd_pd(a, b1, c31);
+			a = _mm512_set1_pd(packedA[4]);
+			c40 = _mm512_fmadd_pd(a, b0, c40); c41 = _mm512_fmadd_pd(a, b1, c41);
+			a = _mm512_set1_pd(packedA[5]);
+			c50 = _mm512_fmadd_pd(a, b0, c50); c51 = _mm512_fmadd_pd(a, b1, c51);
+
+			packedA += GEMM_MR;
+			packedB += 16;
+		}
+
+		const __m512d rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			double* row = c + i * ldc;
+			__m512d lo = rows[i][0];
+			__m512d hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm512_add_pd(lo, _mm512_loadu_pd(row));
+				hi = _mm512_add_pd(hi, _mm512_loadu_pd(row + 8));
+			}
+			_mm512_storeu_pd(row, lo);
+			_mm512_storeu_pd(row + 8, hi);
+		}
+	}
+
+	/*
+	 * BF16 without VDPBF16PS: each 32-bit lane of B holds the (even K, odd K) pair of one
+	 * column, and a BF16 is the upper half of a float, so a shift widens the even values
+	 * and a mask the odd ones. The even and odd products go through the same FMA chain.
+	 */
+	TARGET_AVX2_FMA void MicroKernelBF16AVX2(size_t groups, const BFloat16* packedA, const BFloat16* packedB, float* c, size_t ldc, bool accumulate) {
+		const __m256i oddMask = _mm256_set1_epi32(static_cast<int32_t>(0xffff0000u));
+		__m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+		__m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+		__m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+		__m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+		__m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+		__m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+		for (size_t p = 0; p < groups; p++) {
+			const __m256i pairs0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(packedB));
+			const __m256i pairs1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(packedB + 16));
+			for (size_t q = 0; q < 2; q++) {
+				const __m256 b0 = _mm256_castsi256_ps(q == 0 ? _mm256_slli_epi32(pairs0, 16) : _mm256_and_si256(pairs0, oddMask));
+				const __m256 b1 = _mm256_castsi256_ps(q == 0 ? _mm256_slli_epi32(pairs1, 16) : _mm256_and_si256(pairs1, oddMask));
+				__m256 a;
+
+				a = _mm256_set1_ps(ToFloat(packedA[0 + q]));
+				c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+				a = _mm256_set1_ps(ToFloat(packedA[2 + q]));
+				c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+				a = _mm256_set1_ps(ToFloat(packedA[4 + q]));
+				c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+				a = _mm256_set1_ps(ToFloat(packedA[6 + q]));
+				c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+				a = _mm256_set1_ps(ToFloat(packedA[8 + q]));
+				c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+				a = _mm256_set1_ps(ToFloat(packedA[10 + q]));
+				c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+			}
+
+			packedA += GEMM_MR * 2;
+			packedB += 16 * 2;
+		}
+
+		const __m256 rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			float* row = c + i * ldc;
+			__m256 lo = rows[i][0];
+			__m256 hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm256_add_ps(lo, _mm256_loadu_ps(row));
+				hi = _mm256_add_ps(hi, _mm256_loadu_ps(row + 8));
+			}
+			_mm256_storeu_ps(row, lo);
+			_mm256_storeu_ps(row + 8, hi);
+		}
+	}
+
+	TARGET_AVX512F void MicroKernelBF16AVX512(size_t groups, const BFloat16* packedA, const BFloat16* packedB, float* c, size_t ldc, bool accumulate) {
+		const __m512i oddMask = _mm512_set1_epi32(static_cast<int32_t>(0xffff0000u));
+		__m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+		__m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+		__m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+		__m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+		__m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+		__m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+
+		for (size_t p = 0; p < groups; p++) {
+			const __m512i pairs0 = _mm512_load_si512(packedB);
+			const __m512i pairs1 = _mm512_load_si512(packedB + 32);
+			for (size_t q = 0; q < 2; q++) {
+				/* Zero-masked shift, the unmasked one trips a -Wmaybe-uninitialized false positive in GCC's headers */
+				const __m512 b0 = _mm512_castsi512_ps(q == 0 ? _mm512_maskz_slli_epi32(0xffff, pairs0, 16) : _mm512_and_si512(pairs0, oddMask));
+				const __m512 b1 = _mm512_castsi512_ps(q == 0 ? _mm512_maskz_slli_epi32(0xffff, pairs1, 16) : _mm512_and_si512(pairs1, oddMask));
+				__m512 a;
+
+				a = _mm512_set1_ps(ToFloat(packedA[0 + q]));
+				c00 = _mm512_fmadd_ps(a, b0, c00); c01 = _mm512_fmadd_ps(a, b1, c01);
+				a = _mm512_set1_ps(ToFloat(packedA[2 + q]));
+				c10 = _mm512_fmadd_ps(a, b0, c10); c11 = _mm512_fmadd_ps(a, b1, c11);
+				a = _mm512_set1_ps(ToFloat(packedA[4 + q]));
+				c20 = _mm512_fmadd_ps(a, b0, c20); c21 = _mm512_fmadd_ps(a, b1, c21);
+				a = _mm512_set1_ps(ToFloat(packedA[6 + q]));
+				c30 = _mm512_fmadd_ps(a, b0, c30); c31 = _mm512_fmadd_ps(a, b1, c31);
+				a = _mm512_set1_ps(ToFloat(packedA[8 + q]));
+				c40 = _mm512_fmadd_ps(a, b0, c40); c41 = _mm512_fmadd_ps(a, b1, c41);
+				a = _mm512_set1_ps(ToFloat(packedA[10 + q]));
+				c50 = _mm512_fmadd_ps(a, b0, c50); c51 = _mm512_fmadd_ps(a, b1, c51);
+			}
+
+			packedA += GEMM_MR * 2;
+			packedB += 32 * 2;
+		}
+
+		const __m512 rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			float* row = c + i * ldc;
+			__m512 lo = rows[i][0];
+			__m512 hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm512_add_ps(lo, _mm512_loadu_ps(row));
+				hi = _mm512_add_ps(hi, _mm512_loadu_ps(row + 16));
+			}
+			_mm512_storeu_ps(row, lo);
+			_mm512_storeu_ps(row + 16, hi);
+		}
+	}
+
+	/* VDPBF16PS adds both products of a pair into one FP32 lane, A pairs are broadcast as 32-bit values */
+	TARGET_AVX512_BF16 void MicroKernelBF16AVX512BF16(size_t groups, const BFloat16* packedA, const BFloat16* packedB, float* c, size_t ldc, bool accumulate) {
+		__m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+		__m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+		__m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+		__m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+		__m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+		__m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+
+		for (size_t p = 0; p < groups; p++) {
+			const __m512bh b0 = (__m512bh)_mm512_load_si512(packedB);
+			const __m512bh b1 = (__m512bh)_mm512_load_si512(packedB + 32);
+			__m512bh a;
+
+			a = (__m512bh)_mm512_set1_epi32(LoadGroup(packedA + 0));
+			c00 = _mm512_dpbf16_ps(c00, a, b0); c01 = _mm512_dpbf16_ps(c01, a, b1);
+			a = (__m512bh)_mm512_set1_epi32(LoadGroup(packedA + 2));
+			c10 = _mm512_dpbf16_ps(c10, a, b0); c11 = _mm512_dpbf16_ps(c11, a, b1);
+			a = (__m512bh)_mm512_set1_epi32(LoadGroup(packedA + 4));
+			c20 = _mm512_dpbf16_ps(c20, a, b0); c21 = _mm512_dpbf16_ps(c21, a, b1);
+			a = (__m512bh)_mm512_set1_epi32(LoadGroup(packedA + 6));
+			c30 = _mm512_dpbf16_ps(c30, a, b0); c31 = _mm512_dpbf16_ps(c31, a, b1);
+			a = (__m512bh)_mm512_set1_epi32(LoadGroup(packedA + 8));
+			c40 = _mm512_dpbf16_ps(c40, a, b0); c41 = _mm512_dpbf16_ps(c41, a, b1);
+			a = (__m512bh)_mm512_set1_epi32(LoadGroup(packedA + 10));
+			c50 = _mm512_dpbf16_ps(c50, a, b0); c51 = _mm512_dpbf16_ps(c51, a, b1);
+
+			packedA += GEMM_MR * 2;
+			packedB += 32 * 2;
+		}
+
+		const __m512 rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			float* row = c + i * ldc;
+			__m512 lo = rows[i][0];
+			__m512 hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm512_add_ps(lo, _mm512_loadu_ps(row));
+				hi = _mm512_add_ps(hi, _mm512_loadu_ps(row + 16));
+			}
+			_mm512_storeu_ps(row, lo);
+			_mm512_storeu_ps(row + 16, hi);
+		}
+	}
+
+	/*
+	 * INT8 without VNNI: bytes are widened to 16 bits and VPMADDWD sums pairs of
+	 * products, so each accumulator lane holds half of one column's quad. VPMADDUBSW
+	 * would skip the widening but saturates for full-range operands. The halves
+	 * are folded once at the end with a horizontal add.
+	 */
+	TARGET_AVX2_FMA void MicroKernelInt8AVX2(size_t groups, const uint8_t* packedA, const int8_t* packedB, int32_t* c, size_t ldc, bool accumulate) {
+		__m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+		__m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+		__m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+		__m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+		__m256i c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256();
+		__m256i c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();
+
+		for (size_t p = 0; p < groups; p++) {
+			const __m256i b0 = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(packedB)));
+			const __m256i b1 = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(packedB + 16)));
+			__m256i a;
+
+			a = _mm256_cvtepu8_epi16(_mm_set1_epi32(LoadGroup(packedA + 0)));
+			c00 = _mm256_add_epi32(c00, _mm256_madd_epi16(a, b0)); c01 = _mm256_add_epi32(c01, _mm256_madd_epi16(a, b1));
+			a = _mm256_cvtepu8_epi16(_mm_set1_epi32(LoadGroup(packedA + 4)));
+			c10 = _mm256_add_epi32(c10, _mm256_madd_epi16(a, b0)); c11 = _mm256_add_epi32(c11, _mm256_madd_epi16(a, b1));
+			a = _mm256_cvtepu8_epi16(_mm_set1_epi32(LoadGroup(packedA + 8)));
+			c20 = _mm256_add_epi32(c20, _mm256_madd_epi16(a, b0)); c21 = _mm256_add_epi32(c21, _mm256_madd_epi16(a, b1));
+			a = _mm256_cvtepu8_epi16(_mm_set1_epi32(LoadGroup(packedA + 12)));
+			c30 = _mm256_add_epi32(c30, _mm256_madd_epi16(a, b0)); c31 = _mm256_add_epi32(c31, _mm256_madd_epi16(a, b1));
+			a = _mm256_cvtepu8_epi16(_mm_set1_epi32(LoadGroup(packedA + 16)));
+			c40 = _mm256_add_epi32(c40, _mm256_madd_epi16(a, b0)); c41 = _mm256_add_epi32(c41, _mm256_madd_epi16(a, b1));
+			a = _mm256_cvtepu8_epi16(_mm_set1_epi32(LoadGroup(packedA + 20)));
+			c50 = _mm256_add_epi32(c50, _mm256_madd_epi16(a, b0)); c51 = _mm256_add_epi32(c51, _mm256_madd_epi16(a, b1));
+
+			packedA += GEMM_MR * 4;
+			packedB += 8 * 4;
+		}
+
+		const __m256i rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			int32_t* row = c + i * ldc;
+			/* hadd leaves columns 0 1 4 5 | 2 3 6 7, the permute restores their order */
+			__m256i sum = _mm256_permute4x64_epi64(_mm256_hadd_epi32(rows[i][0], rows[i][1]), _MM_SHUFFLE(3, 1, 2, 0));
+			if (accumulate)
+				sum = _mm256_add_epi32(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(row), sum);
+		}
+	}
+
+	/* VPDPBUSD sums a quad of u8 x s8 products straight into an INT32 lane */
+	TARGET_AVX_VNNI void MicroKernelInt8AVXVNNI(size_t groups, const uint8_t* packedA, const int8_t* packedB, int32_t* c, size_t ldc, bool accumulate) {
+		__m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+		__m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+		__m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+		__m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+		__m256i c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256();
+		__m256i c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();
+
+		for (size_t p = 0; p < groups; p++) {
+			const __m256i b0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(packedB));
+			const __m256i b1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(packedB + 32));
+			__m256i a;
+
+			a = _mm256_set1_epi32(LoadGroup(packedA + 0));
+			c00 = _mm256_dpbusd_avx_epi32(c00, a, b0); c01 = _mm256_dpbusd_avx_epi32(c01, a, b1);
+			a = _mm256_set1_epi32(LoadGroup(packedA + 4));
+			c10 = _mm256_dpbusd_avx_epi32(c10, a, b0); c11 = _mm256_dpbusd_avx_epi32(c11, a, b1);
+			a = _mm256_set1_epi32(LoadGroup(packedA + 8));
+			c20 = _mm256_dpbusd_avx_epi32(c20, a, b0); c21 = _mm256_dpbusd_avx_epi32(c21, a, b1);
+			a = _mm256_set1_epi32(LoadGroup(packedA + 12));
+			c30 = _mm256_dpbusd_avx_epi32(c30, a, b0); c31 = _mm256_dpbusd_avx_epi32(c31, a, b1);
+			a = _mm256_set1_epi32(LoadGroup(packedA + 16));
+			c40 = _mm256_dpbusd_avx_epi32(c40, a, b0); c41 = _mm256_dpbusd_avx_epi32(c41, a, b1);
+			a = _mm256_set1_epi32(LoadGroup(packedA + 20));
+			c50 = _mm256_dpbusd_avx_epi32(c50, a, b0); c51 = _mm256_dpbusd_avx_epi32(c51, a, b1);
+
+			packedA += GEMM_MR * 4;
+			packedB += 16 * 4;
+		}
+
+		const __m256i rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			__m256i* row = reinterpret_cast<__m256i*>(c + i * ldc);
+			__m256i lo = rows[i][0];
+			__m256i hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm256_add_epi32(lo, _mm256_loadu_si256(row));
+				hi = _mm256_add_epi32(hi, _mm256_loadu_si256(row + 1));
+			}
+			_mm256_storeu_si256(row, lo);
+			_mm256_storeu_si256(row + 1, hi);
+		}
+	}
+
+	TARGET_AVX512_VNNI void MicroKernelInt8AVX512VNNI(size_t groups, const uint8_t* packedA, const int8_t* packedB, int32_t* c, size_t ldc, bool accumulate) {
+		__m512i c00 = _mm512_setzero_si512(), c01 = _mm512_setzero_si512();
+		__m512i c10 = _mm512_setzero_si512(), c11 = _mm512_setzero_si512();
+		__m512i c20 = _mm512_setzero_si512(), c21 = _mm512_setzero_si512();
+		__m512i c30 = _mm512_setzero_si512(), c31 = _mm512_setzero_si512();
+		__m512i c40 = _mm512_setzero_si512(), c41 = _mm512_setzero_si512();
+		__m512i c50 = _mm512_setzero_si512(), c51 = _mm512_setzero_si512();
+
+		for (size_t p = 0; p < groups; p++) {
+			const __m512i b0 = _mm512_load_si512(packedB);
+			const __m512i b1 = _mm512_load_si512(packedB + 64);
+			__m512i a;
+
+			a = _mm512_set1_epi32(LoadGroup(packedA + 0));
+			c00 = _mm512_dpbusd_epi32(c00, a, b0); c01 = _mm512_dpbusd_epi32(c01, a, b1);
+			a = _mm512_set1_epi32(LoadGroup(packedA + 4));
+			c10 = _mm512_dpbusd_epi32(c10, a, b0); c11 = _mm512_dpbusd_epi32(c11, a, b1);
+			a = _mm512_set1_epi32(LoadGroup(packedA + 8));
+			c20 = _mm512_dpbusd_epi32(c20, a, b0); c21 = _mm512_dpbusd_epi32(c21, a, b1);
+			a = _mm512_set1_epi32(LoadGroup(packedA + 12));
+			c30 = _mm512_dpbusd_epi32(c30, a, b0); c31 = _mm512_dpbusd_epi32(c31, a, b1);
+			a = _mm512_set1_epi32(LoadGroup(packedA + 16));
+			c40 = _mm512_dpbusd_epi32(c40, a, b0); c41 = _mm512_dpbusd_epi32(c41, a, b1);
+			a = _mm512_set1_epi32(LoadGroup(packedA + 20));
+			c50 = _mm512_dpbusd_epi32(c50, a, b0); c51 = _mm512_dpbusd_epi32(c51, a, b1);
+
+			packedA += GEMM_MR * 4;
+			packedB += 32 * 4;
+		}
+
+		const __m512i rows[GEMM_MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+		for (size_t i = 0; i < GEMM_MR; i++) {
+			int32_t* row = c + i * ldc;
+			__m512i lo = rows[i][0];
+			__m512i hi = rows[i][1];
+			if (accumulate) {
+				lo = _mm512_add_epi32(lo, _mm512_loadu_si512(row));
+				hi = _mm512_add_epi32(hi, _mm512_loadu_si512(row + 16));
+			}
+			_mm512_storeu_si512(row, lo);
+			_mm512_storeu_si512(row + 16, hi);
+		}
+	}
+#endif
+
+	/* Kernels of each type combination, from the most to the least portable */
+	template<typename TA, typename TB, typename TC>
+	struct GemmKernelTable;
+
+	template<>
+	struct GemmKernelTable<float, float, float> {
+		static constexpr Gemm::Kernel KERNELS[] = {
+			{ SimdIsa::SCALAR, CpuFeature::NONE, 16, MicroKernelScalar<float, float, float, 16, 1>, "scalar 6x16" },
+#if BENCHMARK_X86
+			{ SimdIsa::SSE42, CpuFeature::NONE, 16, MicroKernelSSE42, "sse4.2 6x16" },
+			{ SimdIsa::AVX2_FMA, CpuFeature::NONE, 16, MicroKernelAVX2, "avx2-fma 6x16" },
+			{ SimdIsa::AVX512F, CpuFeature::NONE, 32, MicroKernelAVX512, "avx512f 6x32" },
+#endif
+		};
+	};
+
+	template<>
+	struct GemmKernelTable<double, double, double> {
+		static constexpr GemmFP64::Kernel KERNELS[] = {
+			{ SimdIsa::SCALAR, CpuFeature::NONE, 8, MicroKernelScalar<double, double, double, 8, 1>, "scalar 6x8" },
+#if BENCHMARK_X86
+			{ SimdIsa::AVX2_FMA, CpuFeature::NONE, 8, MicroKernelFP64AVX2, "avx2-fma 6x8" },
+			{ SimdIsa::AVX512F, CpuFeature::NONE, 16, MicroKernelFP64AVX512, "avx512f 6x16" },
+#endif
+		};
+	};
+
+	/* FP16 is packed as FP32, so it runs the FP32 kernels */
+	template<>
+	struct GemmKernelTable<Float16, Float16, float> {
+		static constexpr GemmFP16::Kernel KERNELS[] = {
+			{ SimdIsa::SCALAR, CpuFeature::NONE, 16, MicroKernelScalar<float, float, float, 16, 1>, "fp32 scalar 6x16" },
+#if BENCHMARK_X86
+			{ SimdIsa::SSE42, CpuFeature::NONE, 16, MicroKernelSSE42, "fp32 sse4.2 6x16" },
+			{ SimdIsa::AVX2_FMA, CpuFeature::NONE, 16, MicroKernelAVX2, "fp32 avx2-fma 6x16" },
+			{ SimdIsa::AVX512F, CpuFeature::NONE, 32, MicroKernelAVX512, "fp32 avx512f 6x32" },
+#endif
+		};
+	};
+
+	template<>
+	struct GemmKernelTable<BFloat16, BFloat16, float> {
+		static constexpr GemmBF16::Kernel KERNELS[] = {
+			{ SimdIsa::SCALAR, CpuFeature::NONE, 16, MicroKernelScalar<BFloat16, BFloat16, float, 16, 2>, "scalar 6x16" },
+#if BENCHMARK_X86
+			{ SimdIsa::AVX2_FMA, CpuFeature::NONE, 16, MicroKernelBF16AVX2, "avx2-fma 6x16" },
+			{ SimdIsa::AVX512F, CpuFeature::NONE, 32, MicroKernelBF16AVX512, "avx512f 6x32" },
+			{ SimdIsa::AVX512F, CpuFeature::AVX512_BF16, 32, MicroKernelBF16AVX512BF16, "avx512-bf16 6x32" },
+#endif
+		};
+	};
+
+	template<>
+	struct GemmKernelTable<uint8_t, int8_t, int32_t> {
+		static constexpr GemmInt8::Kernel KERNELS[] = {
+			{ SimdIsa::SCALAR, CpuFeature::NONE, 16, MicroKernelScalar<uint8_t, int8_t, int32_t, 16, 4>, "scalar 6x16" },
+#if BENCHMARK_X86
+			{ SimdIsa::AVX2_FMA, CpuFeature::NONE, 8, MicroKernelInt8AVX2, "avx2 6x8" },
+			{ SimdIsa::AVX2_FMA, CpuFeature::AVX_VNNI, 16, MicroKernelInt8AVXVNNI, "avx-vnni 6x16" },
+			{ SimdIsa::AVX512F, CpuFeature::AVX512_VNNI, 32, MicroKernelInt8AVX512VNNI, "avx512-vnni 6x32" },
+#endif
+		};
+	};
+}
+
+template<typename TA, typename TB, typename TC>
+const typename GemmEngine<TA, TB, TC>::Kernel& GemmEngine<TA, TB, TC>::GetKernel() {
+	/* The last kernel the active ISA and the CPU features allow is the fastest one */
+	const SimdIsa active = IsaDispatch::GetActive();
+	const Kernel* best = &GemmKernelTable<TA, TB, TC>::KERNELS[0];
+	for (const Kernel& kernel : GemmKernelTable<TA, TB, TC>::KERNELS) {
+		if (kernel.isa <= active && IsaDispatch::HasFeature(kernel.feature))
+			best = &kernel;
+	}
+	return *best;
+}
+
+template<typename TA, typename TB, typename TC>
+const char* GemmEngine<TA, TB, TC>::GetKernelName() {
+	return GetKernel().name;
+}
+
+template<typename TA, typename TB, typename TC>
+GemmBlocking GemmEngine<TA, TB, TC>::GetBlocking() {
+	return ComputeBlocking(GetKernel().nr);
+}
+
+template<typename TA, typename TB, typename TC>
+GemmBlocking GemmEngine<TA, TB, TC>::ComputeBlocking(size_t nr) {
+	/* CPUID is slow under virtualization, read the cache sizes only once */
+	static const size_t l1 = L1_CACHE_SIZE;
+	static const size_t l2 = L2_CACHE_SIZE;
+	static const size_t l3 = L3_CACHE_SIZE;
+
+	/*
+	 * Half of each level holds the reused operand, the other half is left to the
+	 * streamed one: a B micro-panel in L1, the packed A block in L2 and the packed
+	 * B block in L3. Bounds keep degenerate cache reports from producing silly tiles,
+	 * and kc stays a whole number of K groups so only the last block is padded.
+	 */
+	GemmBlocking blocking;
+	blocking.kc = std::clamp<size_t>(l1 / 2 / (nr * sizeof(PackedB)), 64, 1024) / K_GROUP * K_GROUP;
+	blocking.mc = std::clamp<size_t>(l2 / 2 / (blocking.kc * sizeof(PackedA)) / GEMM_MR * GEMM_MR, GEMM_MR, 1020);
+	blocking.nc = std::clamp<size_t>(l3 / 2 / (blocking.kc * sizeof(PackedB)) / nr * nr, nr, 4096);
+	return blocking;
+}
+
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::Multiply(MatrixView<const TA> a, MatrixView<const TB> b, MatrixView<TC> c,
+	size_t rowBegin, size_t rowEnd)
+{
+	MultiplyTile(a, b, c, rowBegin, rowEnd, 0, b.Cols());
+}
+
+template<typename TA, typename TB, typename TC>
+GemmTiling GemmEngine<TA, TB, TC>::PlanTiles(size_t rows, size_t cols, int numThreads) {
+	const Kernel& kernel = GetKernel();
+	const GemmBlocking blocking = ComputeBlocking(kernel.nr);
+	const size_t nr = kernel.nr;
+	const size_t minRows = 4 * GEMM_MR;
+	const size_t minCols = 4 * nr;
+	const size_t target = static_cast<size_t>(std::max(numThreads, 1)) * GEMM_TILES_PER_THREAD;
+
+	size_t tileRows = std::max<size_t>(std::min(blocking.mc, rows), GEMM_MR);
+	size_t tileCols = std::max<size_t>(std::min(blocking.nc, cols), nr);
+	tileRows = (tileRows + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+	tileCols = (tileCols + nr - 1) / nr * nr;
+
+	auto count = [&]() { return ((rows + tileRows - 1) / tileRows) * ((cols + tileCols - 1) / tileCols); };
+	while (count() < target && (tileRows > minRows || tileCols > minCols)) {
+		if (tileCols >= tileRows * nr / GEMM_MR && tileCols > minCols)
+			tileCols = std::max(minCols, (tileCols / 2 + nr - 1) / nr * nr);
+		else if (tileRows > minRows)
+			tileRows = std::max(minRows, (tileRows / 2 + GEMM_MR - 1) / GEMM_MR * GEMM_MR);
+		else
+			tileCols = std::max(minCols, (tileCols / 2 + nr - 1) / nr * nr);
+	}
+
+	GemmTiling tiling;
+	tiling.tileRows = tileRows;
+	tiling.tileCols = tileCols;
+	tiling.rowTiles = (rows + tileRows - 1) / tileRows;
+	tiling.colTiles = (cols + tileCols - 1) / tileCols;
+	return tiling;
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::MultiplyTile(MatrixView<const TA> a, MatrixView<const TB> b, MatrixView<TC> c,
+	const GemmTiling& tiling, size_t tileIndex)
+{
+	/* Row-major tile order, so consecutive indices share the same rows of A */
+	const size_t rowBegin = tileIndex / tiling.colTiles * tiling.tileRows;
+	const size_t colBegin = tileIndex % tiling.colTiles * tiling.tileCols;
+	MultiplyTile(a, b, c, rowBegin, std::min(rowBegin + tiling.tileRows, c.Rows()),
+		colBegin, std::min(colBegin + tiling.tileCols, c.Cols()));
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::MultiplyTile(MatrixView<const TA> a, MatrixView<const TB> b, MatrixView<TC> c,
+	size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd)
+{
+	const Kernel& kernel = GetKernel();
+	const GemmBlocking blocking = ComputeBlocking(kernel.nr);
+	const size_t cols = std::min(blocking.nc, colEnd - colBegin);
+	const size_t depth = (std::min(blocking.kc, a.Cols()) + K_GROUP - 1) / K_GROUP * K_GROUP;
+	Matrix<PackedB>& packedBBuffer = GetThreadPackingBuffers<PackedA, PackedB>().b;
+	PackedB* packedB = colBegin < colEnd ? PackingBuffer(packedBBuffer, (cols + kernel.nr - 1) / kernel.nr * kernel.nr * depth) : nullptr;
+
+	MultiplyBlocks(a, c, rowBegin, rowEnd, colBegin, colEnd, [&](size_t jc, size_t nb, size_t pc, size_t kb) {
+		PackB(b, pc, kb, jc, nb, kernel.nr, packedB);
+		return static_cast<const PackedB*>(packedB);
+	});
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::ReserveThreadBuffers(size_t rows, size_t depth, size_t cols) {
+	const Kernel& kernel = GetKernel();
+	const GemmBlocking blocking = ComputeBlocking(kernel.nr);
+	const size_t kc = (std::min(blocking.kc, depth) + K_GROUP - 1) / K_GROUP * K_GROUP;
+	const size_t mc = std::min(blocking.mc, rows);
+	const size_t nc = std::min(blocking.nc, cols);
+	ThreadPackingBuffers<PackedA, PackedB>& buffers = GetThreadPackingBuffers<PackedA, PackedB>();
+	PackingBuffer(buffers.a, (mc + GEMM_MR - 1) / GEMM_MR * GEMM_MR * kc);
+	PackingBuffer(buffers.b, (nc + kernel.nr - 1) / kernel.nr * kernel.nr * kc);
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::PrepareB(size_t depth, size_t cols, GemmPackedB<PackedB>& packed) {
+	const Kernel& kernel = GetKernel();
+	packed.depth = depth;
+	packed.cols = cols;
+	packed.nr = kernel.nr;
+	packed.kc = ComputeBlocking(kernel.nr).kc;
+	packed.paddedCols = (cols + kernel.nr - 1) / kernel.nr * kernel.nr;
+	PackingBuffer(packed.storage, (depth + packed.kc - 1) / packed.kc * packed.kc * packed.paddedCols);
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::PackSharedB(MatrixView<const TB> b, GemmPackedB<PackedB>& packed, size_t part, size_t parts) {
+	/* Whole micro-panels per part, so no two threads write the same cache line */
+	const size_t panels = packed.paddedCols / packed.nr;
+	const size_t colBegin = panels * part / parts * packed.nr;
+	const size_t colEnd = std::min(packed.cols, panels * (part + 1) / parts * packed.nr);
+	if (colBegin >= colEnd)
+		return;
+
+	for (size_t pc = 0; pc < packed.depth; pc += packed.kc) {
+		const size_t kb = std::min(packed.kc, packed.depth - pc);
+		const size_t groups = (kb + K_GROUP - 1) / K_GROUP;
+		PackB(b, pc, kb, colBegin, colEnd - colBegin, packed.nr,
+			packed.storage.Data() + pc * packed.paddedCols + colBegin * groups * K_GROUP);
+	}
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::MultiplyTile(MatrixView<const TA> a, const GemmPackedB<PackedB>& b, MatrixView<TC> c,
+	const GemmTiling& tiling, size_t tileIndex)
+{
+	const size_t rowBegin = tileIndex / tiling.colTiles * tiling.tileRows;
+	const size_t colBegin = tileIndex % tiling.colTiles * tiling.tileCols;
+
+	/* Tiles start on micro-panel boundaries, so the block at (pc, jc) is a slice of the shared panels */
+	MultiplyBlocks(a, c, rowBegin, std::min(rowBegin + tiling.tileRows, c.Rows()), colBegin, std::min(colBegin + tiling.tileCols, c.Cols()),
+		[&](size_t jc, size_t, size_t pc, size_t kb) {
+			const size_t groups = (kb + K_GROUP - 1) / K_GROUP;
+			return static_cast<const PackedB*>(b.storage.Data() + pc * b.paddedCols + jc * groups * K_GROUP);
+		});
+}
+
+template<typename TA, typename TB, typename TC>
+template<typename PanelsOfB>
+void GemmEngine<TA, TB, TC>::MultiplyBlocks(MatrixView<const TA> a, MatrixView<TC> c,
+	size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd, const PanelsOfB& panelsOfB)
+{
+	const Kernel& kernel = GetKernel();
+	const GemmBlocking blocking = ComputeBlocking(kernel.nr);
+	const size_t k = a.Cols();
+	if (rowBegin >= rowEnd || colBegin >= colEnd)
+		return;
+
+	if (k == 0) {
+		for (size_t i = rowBegin; i < rowEnd; i++)
+			std::fill(c.Row(i) + colBegin, c.Row(i) + colEnd, TC{});
+		return;
+	}
+
+	const size_t rows = std::min(blocking.mc, rowEnd - rowBegin);
+	const size_t depth = (std::min(blocking.kc, k) + K_GROUP - 1) / K_GROUP * K_GROUP;
+	PackedA* packedA = PackingBuffer(GetThreadPackingBuffers<PackedA, PackedB>().a, (rows + GEMM_MR - 1) / GEMM_MR * GEMM_MR * depth);
+	alignas(CACHE_LINE_SIZE) TC edge[GEMM_MR * GEMM_MAX_NR];
+
+	for (size_t jc = colBegin; jc < colEnd; jc += blocking.nc) {
+		const size_t nb = std::min(blocking.nc, colEnd - jc);
+
+		for (size_t pc = 0; pc < k; pc += blocking.kc) {
+			const size_t kb = std::min(blocking.kc, k - pc);
+			const size_t groups = (kb + K_GROUP - 1) / K_GROUP;
+			const bool accumulate = pc > 0;  // First block overwrites C, later ones add to it
+			const PackedB* packedB = panelsOfB(jc, nb, pc, kb);
+
+			for (size_t ic = rowBegin; ic < rowEnd; ic += blocking.mc) {
+				const size_t mb = std::min(blocking.mc, rowEnd - ic);
+				PackA(a, ic, mb, pc, kb, packedA);
+
+				for (size_t jr = 0; jr < nb; jr += kernel.nr) {
+					const size_t nr = std::min(kernel.nr, nb - jr);
+					const PackedB* panelB = packedB + jr * groups * K_GROUP;
+
+					for (size_t ir = 0; ir < mb; ir += GEMM_MR) {
+						const size_t mr = std::min<size_t>(GEMM_MR, mb - ir);
+						const PackedA* panelA = packedA + ir * groups * K_GROUP;
+						TC* tile = &c(ic + ir, jc + jr);
+
+						if (mr == GEMM_MR && nr == kernel.nr) {
+							kernel.microKernel(groups, panelA, panelB, tile, c.LeadingDimension(), accumulate);
+							continue;
+						}
+
+						/* Partial tile: run the full kernel into scratch and copy the valid part */
+						kernel.microKernel(groups, panelA, panelB, edge, kernel.nr, false);
+						for (size_t i = 0; i < mr; i++) {
+							TC* row = tile + i * c.LeadingDimension();
+							for (size_t j = 0; j < nr; j++)
+								row[j] = accumulate ? row[j] + edge[i * kernel.nr + j] : edge[i * kernel.nr + j];
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::PackA(MatrixView<const TA> a, size_t rowBegin, size_t rows, size_t kBegin, size_t depth, PackedA* packed) {
+	/* Each row of a micro-panel holds K_GROUP consecutive K values, the last group is zero padded */
+	for (size_t ir = 0; ir < rows; ir += GEMM_MR) {
+		const size_t mr = std::min<size_t>(GEMM_MR, rows - ir);
+		for (size_t p = 0; p < depth; p += K_GROUP) {
+			for (size_t i = 0; i < GEMM_MR; i++) {
+				for (size_t q = 0; q < K_GROUP; q++)
+					packed[q] = i < mr && p + q < depth ? PackValue<PackedA>(a(rowBegin + ir + i, kBegin + p + q)) : PackedA{};
+				packed += K_GROUP;
+			}
+		}
+	}
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmEngine<TA, TB, TC>::PackB(MatrixView<const TB> b, size_t kBegin, size_t depth, size_t colBegin, size_t cols, size_t panelWidth, PackedB* packed) {
+	for (size_t jr = 0; jr < cols; jr += panelWidth) {
+		const size_t nr = std::min(panelWidth, cols - jr);
+		for (size_t p = 0; p < depth; p += K_GROUP) {
+			if constexpr (K_GROUP == 1) {
+				PackRow(b.Row(kBegin + p) + colBegin + jr, nr, packed);
+				std::fill(packed + nr, packed + panelWidth, PackedB{});
+			} else {
+				/* Interleave K_GROUP rows so every column's group is contiguous */
+				for (size_t q = 0; q < K_GROUP; q++) {
+					const TB* row = p + q < depth ? b.Row(kBegin + p + q) + colBegin + jr : nullptr;
+					for (size_t j = 0; j < panelWidth; j++)
+						packed[j * K_GROUP + q] = row && j < nr ? PackValue<PackedB>(row[j]) : PackedB{};
+				}
+			}
+			packed += panelWidth * K_GROUP;
+		}
+	}
+}
+
+template class GemmEngine<float, float, float>;
+template class GemmEngine<double, double, double>;
+template class GemmEngine<Float16, Float16, float>;
+template class GemmEngine<BFloat16, BFloat16, float>;
+template class GemmEngine<uint8_t, int8_t, int32_t>;
@@ -0,0 +1,63 @@
+#include <cmath>
+#include <limits>
+
+#include "Histogram.hpp"
+
+LatencyHistogram::LatencyHistogram()
+	: m_Counts(),
+	m_Min(std::numeric_limits<uint64_t>::max())
+{
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+		m_Counts[i] += other.m_Counts[i];
+	m_TotalCount += other.m_TotalCount;
+	m_Min = std::min(m_Min, other.m_Min);
+	m_Max = std::max(m_Max, other.m_Max);
+}
+
+void LatencyHistogram::Reset() {
+	std::fill(m_Counts.begin(), m_Counts.end(), 0);
+	m_TotalCount = 0;
+	m_Min = std::numeric_limits<uint64_t>::max();
+	m_Max = 0;
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+	return m_TotalCount;
+}
+
+uint64_t LatencyHistogram::GetMin() const {
+	return m_TotalCount > 0 ? m_Min : 0;
+}
+
+uint64_t LatencyHistogram::GetMax() const {
+	return m_Max;
+}
+
+uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const {
+	if (m_TotalCount == 0)
+		return 0;
+	if (percentile >= 100.0)
+		return m_Max;
+
+	const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_TotalCount)));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+		seen += m_Counts[i];
+		if (seen >= target)
+			return std::min(BucketUpperBound(i), m_Max);
+	}
+	return m_Max;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+	if (index < SUB_BUCKET_COUNT)
+		return index;
+
+	const uint64_t offset = index - SUB_BUCKET_COUNT;
+	const int shift = static_cast<int>(offset / SUB_BUCKET_HALF) + 1;
+	const uint64_t sub = offset % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+	return ((sub + 1) << shift) - 1;
+}
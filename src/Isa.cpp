@@ -0,0 +1,181 @@
+#include <cstdint>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	#include <cpuid.h>
+#endif
+
+#include "Isa.hpp"
+#include "Logger.hpp"
+
+std::atomic<SimdIsa> IsaDispatch::s_Active{ SimdIsa::AUTO };
+
+namespace {
+	struct CpuFeatures {
+		bool sse42 = false;
+		bool avx2Fma = false;
+		bool avx512f = false;
+		bool f16c = false;
+		bool avxVnni = false;
+		bool avx512Vnni = false;
+		bool avx512Bf16 = false;
+	};
+
+#if BENCHMARK_X86
+	void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int i = 0; i < 4; ++i)
+			regs[i] = static_cast<unsigned int>(info[i]);
+	#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+	#endif
+	}
+
+	uint64_t ReadXcr0() {
+	#if defined(_MSC_VER)
+		return _xgetbv(0);
+	#else
+		uint32_t lo, hi;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		return (static_cast<uint64_t>(hi) << 32) | lo;
+	#endif
+	}
+#endif
+
+	CpuFeatures DetectFeatures() {
+		CpuFeatures features;
+#if BENCHMARK_X86
+		unsigned int regs[4];
+		Cpuid(0, 0, regs);
+		const unsigned int maxLeaf = regs[0];
+		if (maxLeaf < 1)
+			return features;
+
+		Cpuid(1, 0, regs);
+		const unsigned int ecx1 = regs[2];
+		features.sse42 = (ecx1 & (1u << 20)) != 0;
+
+		/* AVX state has to be enabled by the OS (XCR0), not just present in the CPU */
+		const bool osxsave = (ecx1 & (1u << 27)) != 0;
+		const uint64_t xcr0 = osxsave ? ReadXcr0() : 0;
+		const bool ymmState = (xcr0 & 0x6) == 0x6;       // SSE and AVX state
+		const bool zmmState = (xcr0 & 0xE6) == 0xE6;     // plus opmask and both ZMM halves
+
+		unsigned int ebx7 = 0, ecx7 = 0, eax7sub1 = 0;
+		if (maxLeaf >= 7) {
+			Cpuid(7, 0, regs);
+			ebx7 = regs[1];
+			ecx7 = regs[2];
+			const unsigned int maxSubleaf = regs[0];
+			if (maxSubleaf >= 1) {
+				Cpuid(7, 1, regs);
+				eax7sub1 = regs[0];
+			}
+		}
+
+		const bool avx = (ecx1 & (1u << 28)) != 0;
+		const bool fma = (ecx1 & (1u << 12)) != 0;
+		features.avx2Fma = ymmState && avx && fma && (ebx7 & (1u << 5));
+		features.avx512f = zmmState && (ebx7 & (1u << 16));
+		features.f16c = ymmState && avx && (ecx1 & (1u << 29));
+		features.avxVnni = features.avx2Fma && (eax7sub1 & (1u << 4));
+		features.avx512Vnni = features.avx512f && (ecx7 & (1u << 11));
+		features.avx512Bf16 = features.avx512f && (eax7sub1 & (1u << 5));
+#endif
+		return features;
+	}
+
+	const CpuFeatures& GetFeatures() {
+		static const CpuFeatures features = DetectFeatures();
+		return features;
+	}
+}
+
+bool IsaDispatch::IsSupported(SimdIsa isa) {
+	const CpuFeatures& features = GetFeatures();
+	switch (isa) {
+	case SimdIsa::SCALAR:	return true;
+	case SimdIsa::SSE42:	return features.sse42;
+	case SimdIsa::AVX2_FMA:	return features.avx2Fma;
+	case SimdIsa::AVX512F:	return features.avx512f;
+	default:				return false;
+	}
+}
+
+bool IsaDispatch::HasFeature(CpuFeature feature) {
+	const CpuFeatures& features = GetFeatures();
+	switch (feature) {
+	case CpuFeature::NONE:			return true;
+	case CpuFeature::F16C:			return features.f16c;
+	case CpuFeature::AVX_VNNI:		return features.avxVnni;
+	case CpuFeature::AVX512_VNNI:	return features.avx512Vnni;
+	case CpuFeature::AVX512_BF16:	return features.avx512Bf16;
+	default:						return false;
+	}
+}
+
+SimdIsa IsaDispatch::GetBestSupported() {
+	for (SimdIsa isa : { SimdIsa::AVX512F, SimdIsa::AVX2_FMA, SimdIsa::SSE42 }) {
+		if (IsSupported(isa))
+			return isa;
+	}
+	return SimdIsa::SCALAR;
+}
+
+SimdIsa IsaDispatch::Select(SimdIsa requested) {
+	SimdIsa selected = requested;
+	if (requested == SimdIsa::AUTO) {
+		selected = GetBestSupported();
+	}
+	else if (!IsSupported(requested)) {
+		selected = GetBestSupported();
+		LOG_WARNING("Requested ISA " + IsaToString(requested) + " is not supported on this CPU, using " + IsaToString(selected));
+	}
+
+	s_Active.store(selected, std::memory_order_relaxed);
+	return selected;
+}
+
+SimdIsa IsaDispatch::GetActive() {
+	const SimdIsa active = s_Active.load(std::memory_order_relaxed);
+	if (active != SimdIsa::AUTO)
+		return active;
+
+	/* Nothing selected yet, settle on the best ISA so every later caller sees the same choice */
+	SimdIsa expected = SimdIsa::AUTO;
+	s_Active.compare_exchange_strong(expected, GetBestSupported(), std::memory_order_relaxed);
+	return s_Active.load(std::memory_order_relaxed);
+}
+
+std::string IsaDispatch::IsaToString(SimdIsa isa) {
+	switch (isa) {
+	case SimdIsa::AUTO:		return "auto";
+	case SimdIsa::SCALAR:	return "scalar";
+	case SimdIsa::SSE42:	return "sse4.2";
+	case SimdIsa::AVX2_FMA:	return "avx2";
+	case SimdIsa::AVX512F:	return "avx512";
+	default:				return "unknown";
+	}
+}
+
+SimdIsa IsaDispatch::StringToIsa(const std::string& isaStr) {
+	if (isaStr == "scalar")			return SimdIsa::SCALAR;
+	else if (isaStr == "sse4.2")	return SimdIsa::SSE42;
+	else if (isaStr == "avx2")		return SimdIsa::AVX2_FMA;
+	else if (isaStr == "avx512")	return SimdIsa::AVX512F;
+	else							return DEFAULT_SIMD_ISA;
+}
+
+std::string IsaDispatch::FeatureToString(CpuFeature feature) {
+	switch (feature) {
+	case CpuFeature::NONE:			return "none";
+	case CpuFeature::F16C:			return "f16c";
+	case CpuFeature::AVX_VNNI:		return "avx-vnni";
+	case CpuFeature::AVX512_VNNI:	return "avx512-vnni";
+	case CpuFeature::AVX512_BF16:	return "avx512-bf16";
+	default:						return "unknown";
+	}
+}
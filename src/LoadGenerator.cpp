@@ -0,0 +1,47 @@
+#include <chrono>
+#include <thread>
+
+#include "LoadGenerator.hpp"
+#include "Timer.hpp"
+
+ArrivalSchedule::ArrivalSchedule(ArrivalProcess process, double requestsPerSecond, int64_t startNs, Xoshiro256 random)
+	: m_Process(process),
+	m_IntervalNs(requestsPerSecond > 0.0 ? 1e9 / requestsPerSecond : 0.0),
+	m_NextNs(static_cast<double>(startNs)),
+	m_Random(random),
+	m_Gap(1.0)
+{
+}
+
+int64_t ArrivalSchedule::Next() {
+	const int64_t intended = static_cast<int64_t>(m_NextNs);
+	if (m_Process == ArrivalProcess::POISSON)
+		m_NextNs += m_Gap(m_Random) * m_IntervalNs;
+	else
+		m_NextNs += m_IntervalNs;
+	return intended;
+}
+
+void ArrivalSchedule::WaitUntil(int64_t targetNs) {
+	int64_t now = Timer::NowNs();
+	if (targetNs - now > LOAD_SPIN_THRESHOLD_NS)
+		std::this_thread::sleep_for(std::chrono::nanoseconds(targetNs - now - LOAD_SPIN_THRESHOLD_NS));
+
+	while (Timer::NowNs() < targetNs) {
+		/* Spin, sleeping is too coarse for sub-millisecond arrival gaps */
+	}
+}
+
+std::string ArrivalSchedule::ArrivalProcessToString(ArrivalProcess process) {
+	switch (process) {
+	case ArrivalProcess::CONSTANT:	return "constant";
+	case ArrivalProcess::POISSON:	return "poisson";
+	default:						return "unknown";
+	}
+}
+
+ArrivalProcess ArrivalSchedule::StringToArrivalProcess(const std::string& processStr) {
+	if (processStr == "constant")		return ArrivalProcess::CONSTANT;
+	else if (processStr == "poisson")	return ArrivalProcess::POISSON;
+	else								return DEFAULT_ARRIVAL_PROCESS;
+}
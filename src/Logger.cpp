@@ -15,10 +15,10 @@ Logger::Logger(
 	size_t maxFileSize, 
 	size_t maxBufferSize,
 	std::chrono::milliseconds flushInterval)
-	: m_Filename(filename), 
-	m_CurrentLevel(level), 
+	: m_CurrentLevel(level), 
 	m_MaxFileSize(maxFileSize), 
 	m_MaxBufferSize(maxBufferSize), 
+	m_Filename(filename), 
 	m_FlushInterval(flushInterval)
 {
 	OpenLogFile();
@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+	#include <sys/mman.h>
+#endif
+
+#include "Matrix.hpp"
+
+bool AlignedAllocator::s_HugePages = false;
+
+void* AlignedAllocator::Allocate(size_t bytes) {
+	const bool huge = s_HugePages && bytes >= HUGE_PAGE_SIZE;
+	const size_t alignment = huge ? HUGE_PAGE_SIZE : CACHE_LINE_SIZE;
+
+#if defined(_MSC_VER)
+	void* ptr = _aligned_malloc(bytes, alignment);
+	if (!ptr)
+		throw std::bad_alloc();
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, alignment, bytes) != 0)
+		throw std::bad_alloc();
+#endif
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	/* Only a hint, the kernel falls back to base pages when THP is disabled */
+	if (huge)
+		madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+	return ptr;
+}
+
+void AlignedAllocator::Free(void* ptr) {
+#if defined(_MSC_VER)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+void AlignedAllocator::SetHugePages(bool enabled) {
+	s_HugePages = enabled;
+}
+
+bool AlignedAllocator::UsesHugePages() {
+	return s_HugePages;
+}
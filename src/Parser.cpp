@@ -40,6 +40,141 @@ std::string ConfigParser::log_level() const
     return get_value("log_level", log_level);
 }
 
+std::string ConfigParser::schedule() const
+{
+    std::string schedule = WorkScheduler::ScheduleModeToString(DEFAULT_SCHEDULE_MODE);
+    return get_value("schedule", schedule);
+}
+
+int64_t ConfigParser::chunk_size() const
+{
+    return get_value<int64_t>("chunk_size", DEFAULT_CHUNK_SIZE);
+}
+
+std::string ConfigParser::affinity() const
+{
+    std::string affinity = ThreadPlacement::PlacementPolicyToString(DEFAULT_PLACEMENT_POLICY);
+    return get_value("affinity", affinity);
+}
+
+std::vector<int> ConfigParser::cpu_list() const
+{
+    return get_value("cpu_list", std::vector<int>{});
+}
+
+int ConfigParser::warmup() const
+{
+    return get_value("warmup", BENCHMARK_WARMUP_COUNT);
+}
+
+int ConfigParser::repetitions() const
+{
+    return get_value("repetitions", BENCHMARK_REPETITION_COUNT);
+}
+
+int64_t ConfigParser::iterations() const
+{
+    return get_value<int64_t>("iterations", 0);
+}
+
+int ConfigParser::min_time_ms() const
+{
+    return get_value("min_time_ms", BENCHMARK_MIN_TIME_MS);
+}
+
+bool ConfigParser::perf_counters() const
+{
+    return get_value("perf_counters", true);
+}
+
+bool ConfigParser::scaling() const
+{
+    return get_value("scaling", false);
+}
+
+std::vector<int> ConfigParser::scaling_threads() const
+{
+    return get_value("scaling_threads", std::vector<int>{});
+}
+
+bool ConfigParser::latency() const
+{
+    return get_value("latency", false);
+}
+
+std::vector<double> ConfigParser::load_rates() const
+{
+    return get_value("load_rates", std::vector<double>{});
+}
+
+std::string ConfigParser::arrival() const
+{
+    std::string arrival = ArrivalSchedule::ArrivalProcessToString(DEFAULT_ARRIVAL_PROCESS);
+    return get_value("arrival", arrival);
+}
+
+int ConfigParser::load_duration_ms() const
+{
+    return get_value("load_duration_ms", DEFAULT_LOAD_DURATION_MS);
+}
+
+bool ConfigParser::huge_pages() const
+{
+    return get_value("huge_pages", false);
+}
+
+int ConfigParser::matrix_size() const
+{
+    return get_value("matrix_size", DEFAULT_MATRIX_SIZE);
+}
+
+bool ConfigParser::matrix_sweep() const
+{
+    return get_value("matrix_sweep", false);
+}
+
+std::vector<int> ConfigParser::matrix_sizes() const
+{
+    return get_value("matrix_sizes", std::vector<int>{});
+}
+
+int ConfigParser::strassen_cutoff() const
+{
+    return get_value("strassen_cutoff", STRASSEN_DEFAULT_CUTOFF);
+}
+
+int ConfigParser::sparse_size() const
+{
+    return get_value("sparse_size", SPARSE_DEFAULT_SIZE);
+}
+
+double ConfigParser::sparse_density() const
+{
+    return get_value("sparse_density", SPARSE_DEFAULT_DENSITY);
+}
+
+std::string ConfigParser::sparse_pattern() const
+{
+    std::string pattern = SparseGenerator::PatternToString(DEFAULT_SPARSE_PATTERN);
+    return get_value("sparse_pattern", pattern);
+}
+
+std::string ConfigParser::isa() const
+{
+    std::string isa = IsaDispatch::IsaToString(DEFAULT_SIMD_ISA);
+    return get_value("isa", isa);
+}
+
+uint64_t ConfigParser::seed() const
+{
+    return get_value("seed", static_cast<uint64_t>(DEFAULT_RANDOM_SEED));
+}
+
+std::string ConfigParser::plugin_dir() const
+{
+    return get_value("plugin_dir", std::string(DEFAULT_PLUGIN_DIR));
+}
+
 void ConfigParser::validate() const {
     if (!m_Config.contains("threads") || !m_Config["threads"].is_number()) {
         throw std::runtime_error("Invalid or missing 'threads' in config file");
@@ -68,10 +203,83 @@ ArgumentParser::ArgumentParser(int argc, char** argv, const std::string& config_
     m_App.add_flag("-v, --verbose", m_Verbose, "Enable verbose output")
         ->default_val(config.verbose());
 
-    /* TODO: Add a flag for iteration count of the tests */
-    //m_App.add_flag("-i, --iterations", m_Iterations, "Number of iterations")
-    //    ->check(CLI::PositiveNumber)
-    //    ->default_val(config.iterations());
+    m_App.add_option("-i, --iterations", m_Iterations, "Fixed iterations per trial, skips calibration (0 = calibrate)")
+        ->check(CLI::Range(static_cast<int64_t>(0), static_cast<int64_t>(BENCHMARK_MAX_ITERATION_COUNT)))
+        ->default_val(config.iterations());
+
+    m_App.add_option("--min-time", m_MinTimeMs, "Calibration target per trial in ms (0 = test defaults)")
+        ->check(CLI::NonNegativeNumber)
+        ->default_val(config.min_time_ms());
+
+    m_App.add_flag("--perf,!--no-perf", m_PerfCounters, "Collect hardware performance counters per test")
+        ->default_val(config.perf_counters());
+
+    m_App.add_flag("--scaling", m_Scaling, "Sweep every test over increasing thread counts")
+        ->default_val(config.scaling());
+
+    m_ScalingThreads = config.scaling_threads();
+    m_App.add_option("--scaling-threads", m_ScalingThreads, "Comma separated thread counts for --scaling")
+        ->delimiter(',')
+        ->check(CLI::PositiveNumber);
+
+    m_App.add_flag("--latency", m_Latency, "Record per-iteration latency histograms")
+        ->default_val(config.latency());
+
+    m_LoadRates = config.load_rates();
+    m_App.add_option("--rate", m_LoadRates, "Open-loop target rates in requests/s, comma separated for a sweep")
+        ->delimiter(',')
+        ->check(CLI::PositiveNumber);
+
+    m_App.add_option("--arrival", m_Arrival, "Arrival process for --rate")
+        ->check(CLI::IsMember({ "constant", "poisson" }))
+        ->default_val(config.arrival());
+
+    m_App.add_option("--load-duration", m_LoadDurationMs, "Duration of each --rate point in ms")
+        ->check(CLI::PositiveNumber)
+        ->default_val(config.load_duration_ms());
+
+    m_App.add_flag("--huge-pages", m_HugePages, "Back matrix buffers with transparent huge pages")
+        ->default_val(config.huge_pages());
+
+    m_App.add_option("--matrix-size", m_MatrixSize, "Matrix dimension for matrix_multiplication_test")
+        ->check(CLI::PositiveNumber)
+        ->default_val(config.matrix_size());
+
+    m_App.add_flag("--matrix-sweep", m_MatrixSweep, "Sweep the matrix size and report GFLOP/s against the roofline")
+        ->default_val(config.matrix_sweep());
+
+    m_MatrixSizes = config.matrix_sizes();
+    m_App.add_option("--matrix-sizes", m_MatrixSizes, "Matrix sizes for the sweep, comma separated (implies --matrix-sweep)")
+        ->delimiter(',')
+        ->check(CLI::PositiveNumber);
+
+    m_App.add_option("--strassen-cutoff", m_StrassenCutoff, "Block size at which matrix_multiplication_strassen_test switches to the classical GEMM")
+        ->check(CLI::Range(16, 1 << 16))
+        ->default_val(config.strassen_cutoff());
+
+    m_App.add_option("--sparse-size", m_SparseSize, "Rows and columns of the generated matrix for the sparse tests")
+        ->check(CLI::PositiveNumber)
+        ->default_val(config.sparse_size());
+
+    m_App.add_option("--sparse-density", m_SparseDensity, "Fraction of nonzero entries in the sparse matrix")
+        ->check(CLI::Range(0.0, 1.0))
+        ->default_val(config.sparse_density());
+
+    m_App.add_option("--sparse-pattern", m_SparsePattern, "Nonzero structure of the sparse matrix")
+        ->check(CLI::IsMember({ "banded", "power-law", "random" }))
+        ->default_val(config.sparse_pattern());
+
+    m_App.add_option("--isa", m_Isa, "Instruction set for the SIMD kernels, auto picks the widest supported")
+        ->check(CLI::IsMember({ "auto", "scalar", "sse4.2", "avx2", "avx512" }))
+        ->default_val(config.isa());
+
+    m_App.add_option("--seed", m_Seed, "Seed for test data and the per-thread random streams, 0 picks a fresh one (logged)")
+        ->default_val(config.seed());
+
+    m_App.add_option("--plugin-dir", m_PluginDir, "Directory of test plugins (*.so) to load, empty loads none")
+        ->default_val(config.plugin_dir());
+
+    m_App.add_flag("--list-tests", m_ListTests, "Print the registered tests with their category and supported modes, then exit");
 
     m_App.add_flag("-t, --threads", m_Threads, "Number of threads")
         ->check(CLI::PositiveNumber)
@@ -83,10 +291,53 @@ ArgumentParser::ArgumentParser(int argc, char** argv, const std::string& config_
     m_App.add_flag("-l, --loglevel", m_LogLevel, "Log Level")
         ->default_val(config.log_level());
 
+    m_App.add_option("-s, --schedule", m_Schedule, "Work scheduling for multi-threaded runs")
+        ->check(CLI::IsMember({ "static", "dynamic", "guided", "stealing" }))
+        ->default_val(config.schedule());
+
+    m_App.add_option("--chunk-size", m_ChunkSize, "Iterations claimed per chunk (0 = auto)")
+        ->check(CLI::NonNegativeNumber)
+        ->default_val(config.chunk_size());
+
+    m_App.add_option("-a, --affinity", m_Affinity, "Thread placement policy")
+        ->check(CLI::IsMember({ "none", "compact", "scatter", "smt", "list" }))
+        ->default_val(config.affinity());
+
+    m_CpuList = config.cpu_list();
+    m_App.add_option("--cpu-list", m_CpuList, "Comma separated CPUs for the 'list' placement policy")
+        ->delimiter(',')
+        ->check(CLI::NonNegativeNumber);
+
+    m_App.add_option("-w, --warmup", m_Warmup, "Untimed warmup trials per test")
+        ->check(CLI::NonNegativeNumber)
+        ->default_val(config.warmup());
+
+    m_App.add_option("-r, --repetitions", m_Repetitions, "Measured trials per test")
+        ->check(CLI::PositiveNumber)
+        ->default_val(config.repetitions());
+
     try {
         /* Allowed for debugging purposes */
         m_App.allow_extras();
         m_App.parse(argc, argv);
+
+        /* Each of these replaces the normal run, so only one of them can be used at a time */
+        const int runModes = (m_Scaling ? 1 : 0) + (!m_LoadRates.empty() ? 1 : 0) + (m_MatrixSweep || !m_MatrixSizes.empty() ? 1 : 0);
+        if (runModes > 1)
+            throw CLI::ValidationError("--scaling, --rate and --matrix-sweep/--matrix-sizes are mutually exclusive (also when set in the config file)");
+
+        /* The shipped config repeats the built-in defaults, so a config value only counts as chosen when it differs from them */
+        const struct { TestParam flag; const char* option; bool changedInConfig; } testParams[] = {
+            { TEST_PARAM_MATRIX_SIZE, "--matrix-size", config.matrix_size() != DEFAULT_MATRIX_SIZE },
+            { TEST_PARAM_STRASSEN_CUTOFF, "--strassen-cutoff", config.strassen_cutoff() != STRASSEN_DEFAULT_CUTOFF },
+            { TEST_PARAM_SPARSE_SIZE, "--sparse-size", config.sparse_size() != SPARSE_DEFAULT_SIZE },
+            { TEST_PARAM_SPARSE_DENSITY, "--sparse-density", config.sparse_density() != SPARSE_DEFAULT_DENSITY },
+            { TEST_PARAM_SPARSE_PATTERN, "--sparse-pattern", config.sparse_pattern() != SparseGenerator::PatternToString(DEFAULT_SPARSE_PATTERN) },
+        };
+        for (const auto& param : testParams) {
+            if (m_App.count(param.option) > 0 || param.changedInConfig)
+                m_ExplicitTestParams |= param.flag;
+        }
     }
     catch (const CLI::ParseError& e) {
         std::exit(m_App.exit(e));
@@ -113,6 +364,146 @@ std::string ArgumentParser::log_level() const
     return m_LogLevel;
 }
 
+ScheduleMode ArgumentParser::schedule() const
+{
+    return WorkScheduler::StringToScheduleMode(m_Schedule);
+}
+
+int64_t ArgumentParser::chunk_size() const
+{
+    return m_ChunkSize;
+}
+
+PlacementPolicy ArgumentParser::affinity() const
+{
+    return ThreadPlacement::StringToPlacementPolicy(m_Affinity);
+}
+
+std::vector<int> ArgumentParser::cpu_list() const
+{
+    return m_CpuList;
+}
+
+int ArgumentParser::warmup() const
+{
+    return m_Warmup;
+}
+
+int ArgumentParser::repetitions() const
+{
+    return m_Repetitions;
+}
+
+int64_t ArgumentParser::iterations() const
+{
+    return m_Iterations;
+}
+
+int ArgumentParser::min_time_ms() const
+{
+    return m_MinTimeMs;
+}
+
+bool ArgumentParser::perf_counters() const
+{
+    return m_PerfCounters;
+}
+
+bool ArgumentParser::scaling() const
+{
+    return m_Scaling;
+}
+
+std::vector<int> ArgumentParser::scaling_threads() const
+{
+    return m_ScalingThreads;
+}
+
+bool ArgumentParser::latency() const
+{
+    return m_Latency;
+}
+
+std::vector<double> ArgumentParser::load_rates() const
+{
+    return m_LoadRates;
+}
+
+ArrivalProcess ArgumentParser::arrival() const
+{
+    return ArrivalSchedule::StringToArrivalProcess(m_Arrival);
+}
+
+int ArgumentParser::load_duration_ms() const
+{
+    return m_LoadDurationMs;
+}
+
+bool ArgumentParser::huge_pages() const
+{
+    return m_HugePages;
+}
+
+int ArgumentParser::matrix_size() const
+{
+    return m_MatrixSize;
+}
+
+bool ArgumentParser::matrix_sweep() const
+{
+    return m_MatrixSweep;
+}
+
+std::vector<int> ArgumentParser::matrix_sizes() const
+{
+    return m_MatrixSizes;
+}
+
+int ArgumentParser::strassen_cutoff() const
+{
+    return m_StrassenCutoff;
+}
+
+int ArgumentParser::sparse_size() const
+{
+    return m_SparseSize;
+}
+
+double ArgumentParser::sparse_density() const
+{
+    return m_SparseDensity;
+}
+
+SparsePattern ArgumentParser::sparse_pattern() const
+{
+    return SparseGenerator::StringToPattern(m_SparsePattern);
+}
+
+unsigned ArgumentParser::explicit_test_params() const
+{
+    return m_ExplicitTestParams;
+}
+
+SimdIsa ArgumentParser::isa() const
+{
+    return IsaDispatch::StringToIsa(m_Isa);
+}
+
+uint64_t ArgumentParser::seed() const
+{
+    return m_Seed;
+}
+
+std::string ArgumentParser::plugin_dir() const
+{
+    return m_PluginDir;
+}
+
+bool ArgumentParser::list_tests() const
+{
+    return m_ListTests;
+}
+
 std::vector<std::string> ArgumentParser::GetTestNames() const
 {
     return m_TestNames;
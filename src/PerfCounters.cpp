@@ -0,0 +1,203 @@
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+#include "PerfCounters.hpp"
+#include "Logger.hpp"
+
+double PerfCounterValues::Ipc() const {
+	if (!Has(PerfEvent::CYCLES) || !Has(PerfEvent::INSTRUCTIONS) || Get(PerfEvent::CYCLES) == 0)
+		return -1.0;
+	return static_cast<double>(Get(PerfEvent::INSTRUCTIONS)) / Get(PerfEvent::CYCLES);
+}
+
+double PerfCounterValues::MissesPerKiloInstruction(PerfEvent event) const {
+	if (!Has(event) || !Has(PerfEvent::INSTRUCTIONS) || Get(PerfEvent::INSTRUCTIONS) == 0)
+		return -1.0;
+	return Get(event) * 1000.0 / Get(PerfEvent::INSTRUCTIONS);
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other) {
+	for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+		values[i] += other.values[i];
+		available[i] = available[i] || other.available[i];
+	}
+	return *this;
+}
+
+PerfCounters::~PerfCounters() {
+	Close();
+}
+
+std::string PerfCounters::EventToString(PerfEvent event) {
+	switch (event) {
+	case PerfEvent::CYCLES:			return "cycles";
+	case PerfEvent::INSTRUCTIONS:	return "instructions";
+	case PerfEvent::BRANCH_MISSES:	return "branch-misses";
+	case PerfEvent::L1D_MISSES:		return "L1-dcache-load-misses";
+	case PerfEvent::LLC_MISSES:		return "LLC-load-misses";
+	case PerfEvent::DTLB_MISSES:	return "dTLB-load-misses";
+	default:						return "unknown";
+	}
+}
+
+bool PerfCounters::IsAvailable() const {
+	return !m_Groups.empty();
+}
+
+std::string PerfCounters::GetError() const {
+	return m_Error;
+}
+
+#if defined(__linux__)
+
+namespace {
+	struct EventConfig {
+		uint32_t type;
+		uint64_t config;
+	};
+
+	constexpr uint64_t CacheConfig(uint64_t cache, uint64_t op, uint64_t result) {
+		return cache | (op << 8) | (result << 16);
+	}
+
+	EventConfig GetEventConfig(PerfEvent event) {
+		switch (event) {
+		case PerfEvent::CYCLES:			return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+		case PerfEvent::INSTRUCTIONS:	return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS };
+		case PerfEvent::BRANCH_MISSES:	return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES };
+		case PerfEvent::L1D_MISSES:
+			return { PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) };
+		case PerfEvent::LLC_MISSES:
+			return { PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) };
+		case PerfEvent::DTLB_MISSES:
+			return { PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) };
+		default:						return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+		}
+	}
+
+	int PerfEventOpen(perf_event_attr* attr, pid_t tid, int groupFd) {
+		return static_cast<int>(syscall(SYS_perf_event_open, attr, tid, -1, groupFd, 0));
+	}
+}
+
+bool PerfCounters::Open(const std::vector<int64_t>& threadIds) {
+	Close();
+
+	if (!OpenGroup(0, true)) {
+		LOG_WARNING("Hardware performance counters unavailable: " + m_Error
+			+ " (check /proc/sys/kernel/perf_event_paranoid)");
+		return false;
+	}
+
+	for (int64_t threadId : threadIds) {
+		if (!OpenGroup(threadId, false))
+			LOG_WARNING("Performance counters unavailable for thread " + std::to_string(threadId) + ": " + m_Error);
+	}
+	return true;
+}
+
+bool PerfCounters::OpenGroup(int64_t threadId, bool inherit) {
+	Group group;
+	group.fds.fill(-1);
+
+	for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+		const EventConfig eventConfig = GetEventConfig(static_cast<PerfEvent>(i));
+
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = eventConfig.type;
+		attr.config = eventConfig.config;
+		attr.disabled = (i == 0);  // Members follow the leader
+		attr.inherit = inherit;
+		attr.exclude_kernel = 1;   // Allowed up to perf_event_paranoid = 2
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		const int fd = PerfEventOpen(&attr, static_cast<pid_t>(threadId), i == 0 ? -1 : group.fds[0]);
+		if (fd < 0) {
+			if (i == 0) {
+				m_Error = std::strerror(errno);
+				return false;
+			}
+			LOG_DEBUG("Skipping perf event " + EventToString(static_cast<PerfEvent>(i)) + ": " + std::strerror(errno));
+			continue;
+		}
+		group.fds[i] = fd;
+	}
+
+	m_Groups.push_back(group);
+	return true;
+}
+
+void PerfCounters::Close() {
+	for (Group& group : m_Groups) {
+		for (int fd : group.fds) {
+			if (fd >= 0)
+				close(fd);
+		}
+	}
+	m_Groups.clear();
+}
+
+void PerfCounters::Start() {
+	for (const Group& group : m_Groups) {
+		ioctl(group.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(group.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+PerfCounterValues PerfCounters::Stop() {
+	for (const Group& group : m_Groups)
+		ioctl(group.fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	PerfCounterValues result;
+	for (const Group& group : m_Groups) {
+		for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+			if (group.fds[i] < 0)
+				continue;
+
+			uint64_t data[3] = { 0, 0, 0 };  // value, time enabled, time running
+			if (read(group.fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+				continue;
+
+			/* A group that never got scheduled on the PMU reads zero, scale multiplexed ones back up */
+			uint64_t value = data[0];
+			if (data[2] > 0 && data[2] < data[1])
+				value = static_cast<uint64_t>(static_cast<double>(value) * data[1] / data[2]);
+
+			result.values[i] += value;
+			result.available[i] = result.available[i] || data[2] > 0;
+		}
+	}
+	return result;
+}
+
+#else
+
+bool PerfCounters::Open(const std::vector<int64_t>&) {
+	m_Error = "perf_event_open is only available on Linux";
+	LOG_WARNING("Hardware performance counters unavailable: " + m_Error);
+	return false;
+}
+
+bool PerfCounters::OpenGroup(int64_t, bool) {
+	return false;
+}
+
+void PerfCounters::Close() {}
+
+void PerfCounters::Start() {}
+
+PerfCounterValues PerfCounters::Stop() {
+	return PerfCounterValues();
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include <dlfcn.h>
+
+#include "Logger.hpp"
+#include "PluginLoader.hpp"
+
+int PluginLoader::LoadDirectory(const std::string& directory) {
+	std::error_code error;
+	if (directory.empty() || !std::filesystem::is_directory(directory, error)) {
+		LOG_DEBUG("No plugin directory " + directory + ", no plugins loaded");
+		return 0;
+	}
+
+	std::vector<std::filesystem::path> libraries;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".so")
+			libraries.push_back(entry.path());
+	}
+	std::sort(libraries.begin(), libraries.end());
+
+	int registered = 0;
+	for (const std::filesystem::path& library : libraries)
+		registered += Load(library.string());
+	return registered;
+}
+
+int PluginLoader::Load(const std::string& path) {
+	void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (handle == nullptr) {
+		LOG_WARNING("Failed to load plugin " + path + ": " + dlerror());
+		return 0;
+	}
+
+	const auto entry = reinterpret_cast<BenchmarkPluginEntry>(dlsym(handle, BENCHMARK_PLUGIN_ENTRY));
+	const BenchmarkPluginInfo* info = entry != nullptr ? entry() : nullptr;
+	if (info == nullptr) {
+		LOG_WARNING("Plugin " + path + " does not export " + BENCHMARK_PLUGIN_ENTRY + ", skipped");
+		dlclose(handle);
+		return 0;
+	}
+	if (info->abiVersion != BENCHMARK_PLUGIN_ABI_VERSION) {
+		LOG_WARNING("Plugin " + path + " was built for ABI version " + std::to_string(info->abiVersion)
+			+ ", this build expects " + std::to_string(BENCHMARK_PLUGIN_ABI_VERSION) + ", skipped");
+		dlclose(handle);
+		return 0;
+	}
+
+	const std::string pluginName = info->name != nullptr ? info->name : path;
+	int registered = 0;
+	for (size_t i = 0; i < info->testCount; i++) {
+		const BenchmarkPluginTest& test = info->tests[i];
+		if (test.name == nullptr || test.create == nullptr) {
+			LOG_WARNING("Plugin " + pluginName + ": test entry " + std::to_string(i) + " has no name or factory, skipped");
+			continue;
+		}
+		if (TestRegistry::Find(test.name) != nullptr) {
+			LOG_WARNING("Plugin " + pluginName + ": test " + test.name + " already exists, skipped");
+			continue;
+		}
+
+		TestInfo testInfo;
+		testInfo.name = test.name;
+		testInfo.category = TestRegistry::StringToCategory(test.category != nullptr ? test.category : "");
+		testInfo.modes = test.modes;
+		testInfo.description = test.description != nullptr ? test.description : "";
+
+		const auto create = test.create;
+		const std::string testName = test.name;
+		testInfo.factory = [create, testName](const TestParams& params) -> std::unique_ptr<BenchmarkTest> {
+			const BenchmarkPluginParams pluginParams = ToPluginParams(params);
+			std::unique_ptr<BenchmarkTest> instance(create(&pluginParams));
+			if (instance == nullptr)
+				LOG_WARNING("Plugin test " + testName + " could not be created");
+			return instance;
+		};
+
+		TestRegistry::Register(std::move(testInfo));
+		registered++;
+	}
+
+	if (registered == 0) {
+		dlclose(handle);
+		return 0;
+	}
+
+	LOG_INFO("Loaded plugin " + pluginName + " from " + path + " with " + std::to_string(registered) + " test(s)");
+	return registered;
+}
+
+BenchmarkPluginParams PluginLoader::ToPluginParams(const TestParams& params) {
+	BenchmarkPluginParams pluginParams{};
+	pluginParams.matrixSize = params.matrixSize;
+	pluginParams.strassenCutoff = params.strassenCutoff;
+	pluginParams.sparseSize = params.sparse.size;
+	pluginParams.sparseDensity = params.sparse.density;
+	pluginParams.sparsePattern = static_cast<int32_t>(params.sparse.pattern);
+	return pluginParams;
+}
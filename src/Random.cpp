@@ -0,0 +1,47 @@
+#include <random>
+
+#include "Random.hpp"
+
+namespace {
+	uint64_t SplitMix64(uint64_t& state) {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+}
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+	for (uint64_t& word : m_State)
+		word = SplitMix64(seed);
+}
+
+Xoshiro256 Xoshiro256::Stream(uint64_t seed, uint64_t index) {
+	Xoshiro256 generator(seed);
+	for (uint64_t i = 0; i < index; i++)
+		generator.Jump();
+	return generator;
+}
+
+uint64_t Xoshiro256::RandomSeed() {
+	std::random_device device;
+	const uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+	return seed != 0 ? seed : 1;
+}
+
+void Xoshiro256::Jump() {
+	static constexpr uint64_t JUMP[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+
+	uint64_t s[4] = { 0, 0, 0, 0 };
+	for (uint64_t word : JUMP) {
+		for (int bit = 0; bit < 64; bit++) {
+			if (word & (uint64_t(1) << bit)) {
+				for (int k = 0; k < 4; k++)
+					s[k] ^= m_State[k];
+			}
+			Next();
+		}
+	}
+	for (int k = 0; k < 4; k++)
+		m_State[k] = s[k];
+}
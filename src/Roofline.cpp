@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <vector>
+
+#include "Roofline.hpp"
+#include "Isa.hpp"
+#include "Logger.hpp"
+#include "Matrix.hpp"
+#include "System.hpp"
+#include "Timer.hpp"
+
+namespace {
+	/* Runs job on numThreads pool workers, or inline when there is no pool or only one thread */
+	void RunOnThreads(ThreadPool* pool, int numThreads, const ThreadPool::Job& job) {
+		if (pool && numThreads > 1)
+			pool->Run(numThreads, job);
+		else
+			job(0);
+	}
+
+	constexpr int FMA_CHAINS = 12;   // Independent accumulators, enough to cover FMA latency on two ports
+
+	/* Each variant returns a value derived from every accumulator so the loop cannot be discarded */
+	/*
+	 * Plain C++ at the baseline target. Like the scalar GEMM microkernel, the compiler may
+	 * vectorize the lane loop, so this is the roof for portable code rather than for one lane.
+	 */
+	constexpr int SCALAR_LANES = 4;
+	float FmaThroughputScalar(int64_t iterations) {
+		float acc[FMA_CHAINS][SCALAR_LANES];
+		for (int i = 0; i < FMA_CHAINS; ++i)
+			for (int j = 0; j < SCALAR_LANES; ++j)
+				acc[i][j] = static_cast<float>(i);
+
+		for (int64_t it = 0; it < iterations; ++it) {
+			for (int i = 0; i < FMA_CHAINS; ++i)
+				for (int j = 0; j < SCALAR_LANES; ++j)
+					acc[i][j] = acc[i][j] * 0.999999f + 1e-6f;
+		}
+
+		float sum = 0.0f;
+		for (int i = 0; i < FMA_CHAINS; ++i)
+			sum += acc[i][0];
+		return sum;
+	}
+
+#if BENCHMARK_X86
+	/* No FMA below AVX2, a multiply and an add per lane is the best SSE can do */
+	TARGET_SSE42 float FmaThroughputSSE42(int64_t iterations) {
+		const __m128 scale = _mm_set1_ps(0.999999f);
+		const __m128 offset = _mm_set1_ps(1e-6f);
+		__m128 a0 = _mm_set1_ps(0.0f), a1 = _mm_set1_ps(1.0f), a2 = _mm_set1_ps(2.0f);
+		__m128 a3 = _mm_set1_ps(3.0f), a4 = _mm_set1_ps(4.0f), a5 = _mm_set1_ps(5.0f);
+		__m128 a6 = _mm_set1_ps(6.0f), a7 = _mm_set1_ps(7.0f), a8 = _mm_set1_ps(8.0f);
+		__m128 a9 = _mm_set1_ps(9.0f), a10 = _mm_set1_ps(10.0f), a11 = _mm_set1_ps(11.0f);
+
+		for (int64_t it = 0; it < iterations; ++it) {
+			a0 = _mm_add_ps(_mm_mul_ps(a0, scale), offset); a1 = _mm_add_ps(_mm_mul_ps(a1, scale), offset);
+			a2 = _mm_add_ps(_mm_mul_ps(a2, scale), offset); a3 = _mm_add_ps(_mm_mul_ps(a3, scale), offset);
+			a4 = _mm_add_ps(_mm_mul_ps(a4, scale), offset); a5 = _mm_add_ps(_mm_mul_ps(a5, scale), offset);
+			a6 = _mm_add_ps(_mm_mul_ps(a6, scale), offset); a7 = _mm_add_ps(_mm_mul_ps(a7, scale), offset);
+			a8 = _mm_add_ps(_mm_mul_ps(a8, scale), offset); a9 = _mm_add_ps(_mm_mul_ps(a9, scale), offset);
+			a10 = _mm_add_ps(_mm_mul_ps(a10, scale), offset); a11 = _mm_add_ps(_mm_mul_ps(a11, scale), offset);
+		}
+
+		const __m128 sum = _mm_add_ps(
+			_mm_add_ps(_mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)), _mm_add_ps(a4, a5)),
+			_mm_add_ps(_mm_add_ps(_mm_add_ps(a6, a7), _mm_add_ps(a8, a9)), _mm_add_ps(a10, a11)));
+		return _mm_cvtss_f32(sum);
+	}
+
+	/* Spelled out so the accumulators stay in registers instead of an array the compiler may spill */
+	TARGET_AVX2_FMA float FmaThroughputAVX2(int64_t iterations) {
+		const __m256 scale = _mm256_set1_ps(0.999999f);
+		const __m256 offset = _mm256_set1_ps(1e-6f);
+		__m256 a0 = _mm256_set1_ps(0.0f), a1 = _mm256_set1_ps(1.0f), a2 = _mm256_set1_ps(2.0f);
+		__m256 a3 = _mm256_set1_ps(3.0f), a4 = _mm256_set1_ps(4.0f), a5 = _mm256_set1_ps(5.0f);
+		__m256 a6 = _mm256_set1_ps(6.0f), a7 = _mm256_set1_ps(7.0f), a8 = _mm256_set1_ps(8.0f);
+		__m256 a9 = _mm256_set1_ps(9.0f), a10 = _mm256_set1_ps(10.0f), a11 = _mm256_set1_ps(11.0f);
+
+		for (int64_t it = 0; it < iterations; ++it) {
+			a0 = _mm256_fmadd_ps(a0, scale, offset); a1 = _mm256_fmadd_ps(a1, scale, offset);
+			a2 = _mm256_fmadd_ps(a2, scale, offset); a3 = _mm256_fmadd_ps(a3, scale, offset);
+			a4 = _mm256_fmadd_ps(a4, scale, offset); a5 = _mm256_fmadd_ps(a5, scale, offset);
+			a6 = _mm256_fmadd_ps(a6, scale, offset); a7 = _mm256_fmadd_ps(a7, scale, offset);
+			a8 = _mm256_fmadd_ps(a8, scale, offset); a9 = _mm256_fmadd_ps(a9, scale, offset);
+			a10 = _mm256_fmadd_ps(a10, scale, offset); a11 = _mm256_fmadd_ps(a11, scale, offset);
+		}
+
+		const __m256 sum = _mm256_add_ps(
+			_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)), _mm256_add_ps(a4, a5)),
+			_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(a6, a7), _mm256_add_ps(a8, a9)), _mm256_add_ps(a10, a11)));
+		return _mm256_cvtss_f32(sum);
+	}
+
+	TARGET_AVX512F float FmaThroughputAVX512(int64_t iterations) {
+		const __m512 scale = _mm512_set1_ps(0.999999f);
+		const __m512 offset = _mm512_set1_ps(1e-6f);
+		__m512 a0 = _mm512_set1_ps(0.0f), a1 = _mm512_set1_ps(1.0f), a2 = _mm512_set1_ps(2.0f);
+		__m512 a3 = _mm512_set1_ps(3.0f), a4 = _mm512_set1_ps(4.0f), a5 = _mm512_set1_ps(5.0f);
+		__m512 a6 = _mm512_set1_ps(6.0f), a7 = _mm512_set1_ps(7.0f), a8 = _mm512_set1_ps(8.0f);
+		__m512 a9 = _mm512_set1_ps(9.0f), a10 = _mm512_set1_ps(10.0f), a11 = _mm512_set1_ps(11.0f);
+
+		for (int64_t it = 0; it < iterations; ++it) {
+			a0 = _mm512_fmadd_ps(a0, scale, offset); a1 = _mm512_fmadd_ps(a1, scale, offset);
+			a2 = _mm512_fmadd_ps(a2, scale, offset); a3 = _mm512_fmadd_ps(a3, scale, offset);
+			a4 = _mm512_fmadd_ps(a4, scale, offset); a5 = _mm512_fmadd_ps(a5, scale, offset);
+			a6 = _mm512_fmadd_ps(a6, scale, offset); a7 = _mm512_fmadd_ps(a7, scale, offset);
+			a8 = _mm512_fmadd_ps(a8, scale, offset); a9 = _mm512_fmadd_ps(a9, scale, offset);
+			a10 = _mm512_fmadd_ps(a10, scale, offset); a11 = _mm512_fmadd_ps(a11, scale, offset);
+		}
+
+		const __m512 sum = _mm512_add_ps(
+			_mm512_add_ps(_mm512_add_ps(_mm512_add_ps(a0, a1), _mm512_add_ps(a2, a3)), _mm512_add_ps(a4, a5)),
+			_mm512_add_ps(_mm512_add_ps(_mm512_add_ps(a6, a7), _mm512_add_ps(a8, a9)), _mm512_add_ps(a10, a11)));
+		alignas(64) float lanes[16];
+		_mm512_store_ps(lanes, sum);
+		return lanes[0];
+	}
+#endif
+
+	struct FmaThroughputKernel {
+		float (*run)(int64_t iterations);
+		int width;  // Floats per accumulator
+	};
+
+	/* Same ISA as the GEMM microkernel, so the compute roof matches what the matrix test can reach */
+	FmaThroughputKernel GetFmaThroughputKernel() {
+		switch (IsaDispatch::GetActive()) {
+#if BENCHMARK_X86
+		case SimdIsa::SSE42:	return { FmaThroughputSSE42, 4 };
+		case SimdIsa::AVX2_FMA:	return { FmaThroughputAVX2, 8 };
+		case SimdIsa::AVX512F:	return { FmaThroughputAVX512, 16 };
+#endif
+		default:				return { FmaThroughputScalar, SCALAR_LANES };
+		}
+	}
+}
+
+double RooflineCeilings::RidgePoint() const {
+	return bandwidthGBs > 0.0 ? peakGflops / bandwidthGBs : 0.0;
+}
+
+double RooflineCeilings::AttainableGflops(double intensity) const {
+	return std::min(peakGflops, intensity * bandwidthGBs);
+}
+
+RooflineCeilings Roofline::Measure(ThreadPool* pool, int numThreads) {
+	RooflineCeilings ceilings;
+	ceilings.peakGflops = MeasurePeakGflops(pool, numThreads);
+	ceilings.bandwidthGBs = MeasureTriadBandwidth(pool, numThreads);
+	LOG_INFO("Roofline ceilings on " + std::to_string(numThreads) + " threads: " + std::to_string(ceilings.peakGflops)
+		+ " GFLOP/s peak, " + std::to_string(ceilings.bandwidthGBs) + " GB/s triad bandwidth");
+	return ceilings;
+}
+
+double Roofline::MeasurePeakGflops(ThreadPool* pool, int numThreads) {
+	numThreads = std::max(numThreads, 1);
+	const FmaThroughputKernel kernel = GetFmaThroughputKernel();
+	std::vector<float> sinks(static_cast<size_t>(numThreads) * (CACHE_LINE_SIZE / sizeof(float)));
+	double best = 0.0;
+
+	for (int trial = 0; trial < ROOFLINE_TRIALS; ++trial) {
+		const int64_t start = Timer::NowNs();
+		RunOnThreads(pool, numThreads, [&](int t) {
+			sinks[t * (CACHE_LINE_SIZE / sizeof(float))] = kernel.run(ROOFLINE_FMA_ITERATIONS);
+		});
+		const double seconds = std::max<int64_t>(Timer::NowNs() - start, 1) / 1e9;
+
+		/* Two FLOPs per FMA lane */
+		const double flops = 2.0 * FMA_CHAINS * kernel.width * static_cast<double>(ROOFLINE_FMA_ITERATIONS) * numThreads;
+		best = std::max(best, flops / seconds / 1e9);
+	}
+	LOG_DEBUG("FMA sink value " + std::to_string(sinks[0]));
+	return best;
+}
+
+double Roofline::MeasureTriadBandwidth(ThreadPool* pool, int numThreads) {
+	numThreads = std::max(numThreads, 1);
+
+	/* Each array is several times the last level cache when the bounds allow, so the triad streams from memory */
+	const size_t bytes = std::clamp<size_t>(4 * static_cast<size_t>(L3_CACHE_SIZE), ROOFLINE_STREAM_MIN_BYTES, ROOFLINE_STREAM_MAX_BYTES);
+	const size_t count = bytes / sizeof(double);
+	Matrix<double> a(1, count);
+	Matrix<double> b(1, count);
+	Matrix<double> c(1, count);
+
+	auto slice = [&](int t, size_t& begin, size_t& end) {
+		begin = count * t / numThreads;
+		end = count * (t + 1) / numThreads;
+	};
+
+	/* First touch from the thread that later streams the slice places the pages on its NUMA node */
+	RunOnThreads(pool, numThreads, [&](int t) {
+		size_t begin, end;
+		slice(t, begin, end);
+		for (size_t i = begin; i < end; ++i) {
+			a(0, i) = 0.0;
+			b(0, i) = 1.0;
+			c(0, i) = 2.0;
+		}
+	});
+
+	const double scalar = 3.0;
+	double best = 0.0;
+	for (int trial = 0; trial < ROOFLINE_TRIALS; ++trial) {
+		const int64_t start = Timer::NowNs();
+		RunOnThreads(pool, numThreads, [&](int t) {
+			size_t begin, end;
+			slice(t, begin, end);
+			double* __restrict out = a.Data();
+			const double* __restrict x = b.Data();
+			const double* __restrict y = c.Data();
+			for (size_t i = begin; i < end; ++i)
+				out[i] = x[i] + scalar * y[i];
+		});
+		const double seconds = std::max<int64_t>(Timer::NowNs() - start, 1) / 1e9;
+
+		/* STREAM convention: two reads and one write per element, write-allocate traffic not counted */
+		best = std::max(best, 3.0 * sizeof(double) * count / seconds / 1e9);
+	}
+	LOG_DEBUG("Triad check value " + std::to_string(a(0, count / 2)));
+	return best;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+
+#include "Scheduler.hpp"
+
+WorkScheduler::WorkScheduler(ScheduleMode mode, int64_t totalIterations, int numThreads, int64_t chunkSize)
+	: m_Mode(mode),
+	m_TotalIterations(std::max<int64_t>(totalIterations, 0)),
+	m_NumThreads(std::max(numThreads, 1)),
+	m_ChunkSize(chunkSize),
+	m_Ranges(mode == ScheduleMode::STATIC || mode == ScheduleMode::STEALING ? std::max(numThreads, 1) : 0)
+{
+	if (m_ChunkSize <= 0) {
+		/* Guided mode uses the chunk size as the lower bound, so keep it small there */
+		if (m_Mode == ScheduleMode::GUIDED)
+			m_ChunkSize = 1;
+		else
+			m_ChunkSize = std::max<int64_t>(1, m_TotalIterations / (static_cast<int64_t>(m_NumThreads) * CHUNKS_PER_THREAD));
+	}
+
+	if (m_Mode == ScheduleMode::STATIC || m_Mode == ScheduleMode::STEALING) {
+		for (int t = 0; t < m_NumThreads; ++t) {
+			m_Ranges[t].begin = m_TotalIterations * t / m_NumThreads;
+			m_Ranges[t].end = m_TotalIterations * (t + 1) / m_NumThreads;
+		}
+	}
+}
+
+bool WorkScheduler::NextChunk(int threadIndex, int64_t& begin, int64_t& end) {
+	switch (m_Mode) {
+	case ScheduleMode::STATIC:	return NextStaticChunk(threadIndex, begin, end);
+	case ScheduleMode::DYNAMIC:	return NextDynamicChunk(begin, end);
+	case ScheduleMode::GUIDED:	return NextGuidedChunk(begin, end);
+	case ScheduleMode::STEALING:	return NextStealingChunk(threadIndex, begin, end);
+	default:					return false;
+	}
+}
+
+int64_t WorkScheduler::GetChunkSize() const {
+	return m_ChunkSize;
+}
+
+bool WorkScheduler::NextStaticChunk(int threadIndex, int64_t& begin, int64_t& end) {
+	ThreadRange& range = m_Ranges[threadIndex % m_NumThreads];
+	if (range.claimed || range.begin >= range.end)
+		return false;
+
+	range.claimed = true;
+	begin = range.begin;
+	end = range.end;
+	return true;
+}
+
+bool WorkScheduler::NextDynamicChunk(int64_t& begin, int64_t& end) {
+	begin = m_Next.fetch_add(m_ChunkSize, std::memory_order_relaxed);
+	if (begin >= m_TotalIterations)
+		return false;
+
+	end = std::min(begin + m_ChunkSize, m_TotalIterations);
+	return true;
+}
+
+bool WorkScheduler::NextGuidedChunk(int64_t& begin, int64_t& end) {
+	int64_t current = m_Next.load(std::memory_order_relaxed);
+	int64_t chunk = 0;
+	do {
+		if (current >= m_TotalIterations)
+			return false;
+
+		const int64_t remaining = m_TotalIterations - current;
+		chunk = std::max(m_ChunkSize, remaining / (2 * static_cast<int64_t>(m_NumThreads)));
+		chunk = std::min(chunk, remaining);
+	} while (!m_Next.compare_exchange_weak(current, current + chunk, std::memory_order_relaxed));
+
+	begin = current;
+	end = current + chunk;
+	return true;
+}
+
+bool WorkScheduler::TakeFront(ThreadRange& range, int64_t& begin, int64_t& end) {
+	std::lock_guard<std::mutex> lock(range.lock);
+	if (range.begin >= range.end)
+		return false;
+
+	begin = range.begin;
+	end = std::min(range.begin + m_ChunkSize, range.end);
+	range.begin = end;
+	return true;
+}
+
+bool WorkScheduler::NextStealingChunk(int threadIndex, int64_t& begin, int64_t& end) {
+	ThreadRange& own = m_Ranges[threadIndex % m_NumThreads];
+	if (TakeFront(own, begin, end))
+		return true;
+
+	/* Own range drained: visit the others in ring order and take the back half of the first non-empty one */
+	for (int offset = 1; offset < m_NumThreads; ++offset) {
+		ThreadRange& victim = m_Ranges[(threadIndex + offset) % m_NumThreads];
+		int64_t stolenBegin = 0;
+		int64_t stolenEnd = 0;
+		{
+			std::lock_guard<std::mutex> lock(victim.lock);
+			const int64_t remaining = victim.end - victim.begin;
+			if (remaining <= 0)
+				continue;
+
+			stolenEnd = victim.end;
+			stolenBegin = remaining <= m_ChunkSize ? victim.begin : victim.end - remaining / 2;
+			victim.end = stolenBegin;
+		}
+
+		/* Only the owner ever grows its range, so no thief can observe it half-written */
+		{
+			std::lock_guard<std::mutex> lock(own.lock);
+			own.begin = stolenBegin;
+			own.end = stolenEnd;
+		}
+		if (TakeFront(own, begin, end))
+			return true;
+	}
+	return false;
+}
+
+std::string WorkScheduler::ScheduleModeToString(ScheduleMode mode) {
+	switch (mode) {
+	case ScheduleMode::STATIC:	return "static";
+	case ScheduleMode::DYNAMIC:	return "dynamic";
+	case ScheduleMode::GUIDED:	return "guided";
+	case ScheduleMode::STEALING:	return "stealing";
+	default:					return "unknown";
+	}
+}
+
+ScheduleMode WorkScheduler::StringToScheduleMode(const std::string& modeStr) {
+	if (modeStr == "static")		return ScheduleMode::STATIC;
+	else if (modeStr == "dynamic")	return ScheduleMode::DYNAMIC;
+	else if (modeStr == "guided")	return ScheduleMode::GUIDED;
+	else if (modeStr == "stealing")	return ScheduleMode::STEALING;
+	else							return DEFAULT_SCHEDULE_MODE;
+}
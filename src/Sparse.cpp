@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "Isa.hpp"
+#include "Random.hpp"
+#include "Sparse.hpp"
+
+namespace {
+	/* Count distinct sorted columns in [0, cols) */
+	void SampleColumns(Xoshiro256& gen, size_t cols, size_t count, std::vector<int32_t>& out) {
+		out.clear();
+		count = std::min(count, cols);
+
+		/* Dense rows: selection sampling, one pass over all columns with an exact count */
+		if (count * 4 >= cols) {
+			std::uniform_real_distribution<double> uniform(0.0, 1.0);
+			size_t needed = count;
+			for (size_t j = 0; j < cols && needed > 0; j++) {
+				if (uniform(gen) * static_cast<double>(cols - j) < static_cast<double>(needed)) {
+					out.push_back(static_cast<int32_t>(j));
+					--needed;
+				}
+			}
+			return;
+		}
+
+		/* Sparse rows: draw, sort and drop duplicates until there are enough */
+		std::uniform_int_distribution<int32_t> column(0, static_cast<int32_t>(cols - 1));
+		while (out.size() < count) {
+			for (size_t k = out.size(); k < count; k++)
+				out.push_back(column(gen));
+			std::sort(out.begin(), out.end());
+			out.erase(std::unique(out.begin(), out.end()), out.end());
+		}
+	}
+
+	/* Number of nonzeros of every row, before any columns are placed */
+	std::vector<size_t> RowLengths(SparsePattern pattern, size_t size, double density, Xoshiro256& gen) {
+		const double meanLength = density * static_cast<double>(size);
+		std::vector<size_t> lengths(size, 0);
+
+		if (pattern == SparsePattern::RANDOM) {
+			std::poisson_distribution<int64_t> length(std::max(meanLength, 1e-9));
+			for (size_t& l : lengths)
+				l = std::min(static_cast<size_t>(length(gen)), size);
+		}
+		else if (pattern == SparsePattern::POWER_LAW) {
+			/* Zipf-like lengths scaled to the requested total, then dealt to rows in random order */
+			double weightSum = 0.0;
+			for (size_t r = 0; r < size; r++)
+				weightSum += std::pow(static_cast<double>(r + 1), -POWER_LAW_EXPONENT);
+			const double scale = meanLength * static_cast<double>(size) / weightSum;
+			for (size_t r = 0; r < size; r++) {
+				const double length = std::round(scale * std::pow(static_cast<double>(r + 1), -POWER_LAW_EXPONENT));
+				lengths[r] = std::min(std::max(static_cast<size_t>(length), size_t(1)), size);
+			}
+			std::shuffle(lengths.begin(), lengths.end(), gen);
+		}
+		return lengths;
+	}
+
+#if BENCHMARK_X86
+	TARGET_AVX2_FMA inline float HorizontalSum(__m256 v) {
+		__m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+		return _mm_cvtss_f32(sum);
+	}
+
+	TARGET_AVX2_FMA void SpmvCsrAVX2(const CsrMatrix& a, const float* x, float* y, size_t rowBegin, size_t rowEnd) {
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const int32_t* columns = a.columns.data();
+		const float* values = a.values.data();
+
+		for (size_t i = rowBegin; i < rowEnd; i++) {
+			int64_t k = a.rowOffsets[i];
+			const int64_t end = a.rowOffsets[i + 1];
+
+			__m256 acc = _mm256_setzero_ps();
+			for (; k + 8 <= end; k += 8) {
+				const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns + k));
+				acc = _mm256_fmadd_ps(_mm256_loadu_ps(values + k), _mm256_i32gather_ps(x, index, 4), acc);
+			}
+
+			/* Rows are mostly shorter than a register, so the remainder is a masked gather rather than a scalar loop */
+			if (k < end) {
+				const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(end - k)), lanes);
+				const __m256i index = _mm256_maskload_epi32(columns + k, mask);
+				const __m256 value = _mm256_maskload_ps(values + k, mask);
+				const __m256 gathered = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x, index, _mm256_castsi256_ps(mask), 4);
+				acc = _mm256_fmadd_ps(value, gathered, acc);
+			}
+			y[i] = HorizontalSum(acc);
+		}
+	}
+
+	TARGET_AVX2_FMA void SpmvSellAVX2(const SellMatrix& a, const float* x, float* y, size_t sliceBegin, size_t sliceEnd) {
+		alignas(32) float result[SELL_CHUNK_HEIGHT];
+		for (size_t s = sliceBegin; s < sliceEnd; s++) {
+			const int64_t begin = a.sliceOffsets[s];
+			const int64_t end = a.sliceOffsets[s + 1];
+
+			__m256 acc = _mm256_setzero_ps();
+			for (int64_t k = begin; k < end; k += SELL_CHUNK_HEIGHT) {
+				const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.columns.data() + k));
+				acc = _mm256_fmadd_ps(_mm256_loadu_ps(a.values.data() + k), _mm256_i32gather_ps(x, index, 4), acc);
+			}
+			_mm256_store_ps(result, acc);
+
+			const size_t first = s * SELL_CHUNK_HEIGHT;
+			const size_t count = std::min<size_t>(SELL_CHUNK_HEIGHT, a.rows - first);
+			for (size_t lane = 0; lane < count; lane++)
+				y[a.rowOrder[first + lane]] = result[lane];
+		}
+	}
+
+	/*
+	 * out = sum of values[k] * row columns[k] of X over count entries spaced stride apart,
+	 * vectorized along the dense columns so X is read in contiguous rows instead of gathered
+	 */
+	TARGET_AVX2_FMA void AccumulateRowAVX2(const float* values, const int32_t* columns, int64_t count, int64_t stride,
+		MatrixView<const float> x, float* out)
+	{
+		const size_t n = x.Cols();
+		size_t j = 0;
+		for (; j + 16 <= n; j += 16) {
+			__m256 acc0 = _mm256_setzero_ps();
+			__m256 acc1 = _mm256_setzero_ps();
+			for (int64_t k = 0; k < count; k++) {
+				const __m256 value = _mm256_set1_ps(values[k * stride]);
+				const float* in = x.Row(columns[k * stride]) + j;
+				acc0 = _mm256_fmadd_ps(value, _mm256_loadu_ps(in), acc0);
+				acc1 = _mm256_fmadd_ps(value, _mm256_loadu_ps(in + 8), acc1);
+			}
+			_mm256_storeu_ps(out + j, acc0);
+			_mm256_storeu_ps(out + j + 8, acc1);
+		}
+		for (; j + 8 <= n; j += 8) {
+			__m256 acc = _mm256_setzero_ps();
+			for (int64_t k = 0; k < count; k++)
+				acc = _mm256_fmadd_ps(_mm256_set1_ps(values[k * stride]), _mm256_loadu_ps(x.Row(columns[k * stride]) + j), acc);
+			_mm256_storeu_ps(out + j, acc);
+		}
+		for (; j < n; j++) {
+			float sum = 0.0f;
+			for (int64_t k = 0; k < count; k++)
+				sum += values[k * stride] * x(columns[k * stride], j);
+			out[j] = sum;
+		}
+	}
+
+	TARGET_AVX2_FMA void SpmmCsrAVX2(const CsrMatrix& a, MatrixView<const float> x, MatrixView<float> y, size_t rowBegin, size_t rowEnd) {
+		for (size_t i = rowBegin; i < rowEnd; i++) {
+			const int64_t begin = a.rowOffsets[i];
+			AccumulateRowAVX2(a.values.data() + begin, a.columns.data() + begin, a.rowOffsets[i + 1] - begin, 1, x, y.Row(i));
+		}
+	}
+
+	/* Row by row like CSR, stepping through the slice column-major; the padding adds zeros times row 0 of X */
+	TARGET_AVX2_FMA void SpmmSellAVX2(const SellMatrix& a, MatrixView<const float> x, MatrixView<float> y, size_t sliceBegin, size_t sliceEnd) {
+		for (size_t s = sliceBegin; s < sliceEnd; s++) {
+			const int64_t begin = a.sliceOffsets[s];
+			const int64_t width = (a.sliceOffsets[s + 1] - begin) / SELL_CHUNK_HEIGHT;
+			const size_t first = s * SELL_CHUNK_HEIGHT;
+			for (size_t lane = 0; lane < std::min<size_t>(SELL_CHUNK_HEIGHT, a.rows - first); lane++) {
+				const int64_t offset = begin + static_cast<int64_t>(lane);
+				AccumulateRowAVX2(a.values.data() + offset, a.columns.data() + offset, width, SELL_CHUNK_HEIGHT, x,
+					y.Row(a.rowOrder[first + lane]));
+			}
+		}
+	}
+#endif
+
+	bool UseAVX2() {
+#if BENCHMARK_X86
+		return IsaDispatch::GetActive() >= SimdIsa::AVX2_FMA;
+#else
+		return false;
+#endif
+	}
+}
+
+SellMatrix SellMatrix::FromCsr(const CsrMatrix& csr, size_t sigma) {
+	SellMatrix sell;
+	sell.rows = csr.rows;
+	sell.cols = csr.cols;
+	sell.nonzeros = csr.Nonzeros();
+
+	/* Sorting windows are whole slices, otherwise a slice could straddle two windows */
+	sell.sigma = std::max<size_t>((sigma + SELL_CHUNK_HEIGHT - 1) / SELL_CHUNK_HEIGHT, 1) * SELL_CHUNK_HEIGHT;
+
+	auto length = [&](int32_t row) { return csr.rowOffsets[row + 1] - csr.rowOffsets[row]; };
+	sell.rowOrder.resize(csr.rows);
+	std::iota(sell.rowOrder.begin(), sell.rowOrder.end(), 0);
+	for (size_t w = 0; w < csr.rows; w += sell.sigma) {
+		const auto windowEnd = sell.rowOrder.begin() + std::min(w + sell.sigma, csr.rows);
+		std::stable_sort(sell.rowOrder.begin() + w, windowEnd, [&](int32_t lhs, int32_t rhs) { return length(lhs) > length(rhs); });
+	}
+
+	const size_t slices = (csr.rows + SELL_CHUNK_HEIGHT - 1) / SELL_CHUNK_HEIGHT;
+	sell.sliceOffsets.assign(slices + 1, 0);
+	for (size_t s = 0; s < slices; s++) {
+		int64_t width = 0;
+		for (size_t p = s * SELL_CHUNK_HEIGHT; p < std::min((s + 1) * SELL_CHUNK_HEIGHT, csr.rows); p++)
+			width = std::max(width, length(sell.rowOrder[p]));
+		sell.sliceOffsets[s + 1] = sell.sliceOffsets[s] + width * SELL_CHUNK_HEIGHT;
+	}
+
+	sell.columns.assign(static_cast<size_t>(sell.sliceOffsets[slices]), 0);
+	sell.values.assign(static_cast<size_t>(sell.sliceOffsets[slices]), 0.0f);
+	for (size_t p = 0; p < csr.rows; p++) {
+		const int32_t row = sell.rowOrder[p];
+		const int64_t base = sell.sliceOffsets[p / SELL_CHUNK_HEIGHT] + static_cast<int64_t>(p % SELL_CHUNK_HEIGHT);
+		for (int64_t k = csr.rowOffsets[row], j = 0; k < csr.rowOffsets[row + 1]; k++, j++) {
+			sell.columns[base + j * SELL_CHUNK_HEIGHT] = csr.columns[k];
+			sell.values[base + j * SELL_CHUNK_HEIGHT] = csr.values[k];
+		}
+	}
+	return sell;
+}
+
+CsrMatrix SparseGenerator::Generate(SparsePattern pattern, size_t size, double density, uint64_t seed) {
+	Xoshiro256 gen(seed);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+	CsrMatrix csr;
+	csr.rows = size;
+	csr.cols = size;
+	csr.rowOffsets.assign(size + 1, 0);
+
+	const std::vector<size_t> lengths = RowLengths(pattern, size, density, gen);
+	const size_t halfBand = static_cast<size_t>(std::llround(std::max(density * static_cast<double>(size) - 1.0, 0.0) / 2.0));
+
+	std::vector<int32_t> rowColumns;
+	for (size_t i = 0; i < size; i++) {
+		if (pattern == SparsePattern::BANDED) {
+			rowColumns.clear();
+			for (size_t j = i - std::min(i, halfBand); j <= std::min(i + halfBand, size - 1); j++)
+				rowColumns.push_back(static_cast<int32_t>(j));
+		}
+		else {
+			SampleColumns(gen, size, lengths[i], rowColumns);
+		}
+
+		for (int32_t column : rowColumns) {
+			csr.columns.push_back(column);
+			csr.values.push_back(value(gen));
+		}
+		csr.rowOffsets[i + 1] = static_cast<int64_t>(csr.columns.size());
+	}
+	return csr;
+}
+
+std::string SparseGenerator::PatternToString(SparsePattern pattern) {
+	switch (pattern) {
+	case SparsePattern::BANDED:		return "banded";
+	case SparsePattern::POWER_LAW:	return "power-law";
+	case SparsePattern::RANDOM:		return "random";
+	default:						return "unknown";
+	}
+}
+
+SparsePattern SparseGenerator::StringToPattern(const std::string& patternStr) {
+	if (patternStr == "banded")			return SparsePattern::BANDED;
+	else if (patternStr == "power-law")	return SparsePattern::POWER_LAW;
+	else if (patternStr == "random")	return SparsePattern::RANDOM;
+	else								return DEFAULT_SPARSE_PATTERN;
+}
+
+void SparseKernels::SpmvCsr(const CsrMatrix& a, const float* x, float* y, size_t rowBegin, size_t rowEnd) {
+#if BENCHMARK_X86
+	if (UseAVX2())
+		return SpmvCsrAVX2(a, x, y, rowBegin, rowEnd);
+#endif
+	for (size_t i = rowBegin; i < rowEnd; i++) {
+		float sum = 0.0f;
+		for (int64_t k = a.rowOffsets[i]; k < a.rowOffsets[i + 1]; k++)
+			sum += a.values[k] * x[a.columns[k]];
+		y[i] = sum;
+	}
+}
+
+void SparseKernels::SpmvSell(const SellMatrix& a, const float* x, float* y, size_t sliceBegin, size_t sliceEnd) {
+#if BENCHMARK_X86
+	if (UseAVX2())
+		return SpmvSellAVX2(a, x, y, sliceBegin, sliceEnd);
+#endif
+	float result[SELL_CHUNK_HEIGHT];
+	for (size_t s = sliceBegin; s < sliceEnd; s++) {
+		std::fill(result, result + SELL_CHUNK_HEIGHT, 0.0f);
+		for (int64_t k = a.sliceOffsets[s]; k < a.sliceOffsets[s + 1]; k += SELL_CHUNK_HEIGHT) {
+			for (size_t lane = 0; lane < SELL_CHUNK_HEIGHT; lane++)
+				result[lane] += a.values[k + lane] * x[a.columns[k + lane]];
+		}
+
+		const size_t first = s * SELL_CHUNK_HEIGHT;
+		for (size_t lane = 0; lane < std::min<size_t>(SELL_CHUNK_HEIGHT, a.rows - first); lane++)
+			y[a.rowOrder[first + lane]] = result[lane];
+	}
+}
+
+void SparseKernels::SpmmCsr(const CsrMatrix& a, MatrixView<const float> x, MatrixView<float> y, size_t rowBegin, size_t rowEnd) {
+#if BENCHMARK_X86
+	if (UseAVX2())
+		return SpmmCsrAVX2(a, x, y, rowBegin, rowEnd);
+#endif
+	for (size_t i = rowBegin; i < rowEnd; i++) {
+		float* out = y.Row(i);
+		std::fill(out, out + y.Cols(), 0.0f);
+		for (int64_t k = a.rowOffsets[i]; k < a.rowOffsets[i + 1]; k++) {
+			const float value = a.values[k];
+			const float* in = x.Row(a.columns[k]);
+			for (size_t j = 0; j < x.Cols(); j++)
+				out[j] += value * in[j];
+		}
+	}
+}
+
+void SparseKernels::SpmmSell(const SellMatrix& a, MatrixView<const float> x, MatrixView<float> y, size_t sliceBegin, size_t sliceEnd) {
+#if BENCHMARK_X86
+	if (UseAVX2())
+		return SpmmSellAVX2(a, x, y, sliceBegin, sliceEnd);
+#endif
+	for (size_t s = sliceBegin; s < sliceEnd; s++) {
+		const size_t first = s * SELL_CHUNK_HEIGHT;
+		for (size_t lane = 0; lane < std::min<size_t>(SELL_CHUNK_HEIGHT, a.rows - first); lane++) {
+			float* out = y.Row(a.rowOrder[first + lane]);
+			std::fill(out, out + y.Cols(), 0.0f);
+			for (int64_t k = a.sliceOffsets[s] + static_cast<int64_t>(lane); k < a.sliceOffsets[s + 1]; k += SELL_CHUNK_HEIGHT) {
+				const float value = a.values[k];
+				const float* in = x.Row(a.columns[k]);
+				for (size_t j = 0; j < x.Cols(); j++)
+					out[j] += value * in[j];
+			}
+		}
+	}
+}
+
+std::vector<size_t> SparseKernels::PartitionByNonzeros(const std::vector<int64_t>& offsets, size_t parts) {
+	const size_t ranges = offsets.empty() ? 0 : offsets.size() - 1;
+	const int64_t total = offsets.empty() ? 0 : offsets.back();
+	parts = std::max<size_t>(parts, 1);
+
+	std::vector<size_t> bounds(parts + 1, ranges);
+	bounds[0] = 0;
+	for (size_t p = 1; p < parts; p++) {
+		/* First range starting at or after the p-th share of the entries */
+		const int64_t target = static_cast<int64_t>(static_cast<double>(total) * p / parts);
+		const size_t bound = static_cast<size_t>(std::lower_bound(offsets.begin(), offsets.begin() + ranges, target) - offsets.begin());
+		bounds[p] = std::max(bound, bounds[p - 1]);
+	}
+	return bounds;
+}
+
+std::string SparseKernels::GetKernelName() {
+	return UseAVX2() ? "avx2 gather" : "scalar";
+}
+
+std::string SparseKernels::FormatToString(SparseFormat format) {
+	switch (format) {
+	case SparseFormat::CSR:		return "csr";
+	case SparseFormat::SELL:	return "sell";
+	default:					return "unknown";
+	}
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "Statistics.hpp"
+
+SampleStatistics Statistics::Compute(const std::vector<double>& samples) {
+	SampleStatistics stats;
+	stats.count = samples.size();
+	if (samples.empty())
+		return stats;
+
+	const auto minmax = std::minmax_element(samples.begin(), samples.end());
+	stats.min = *minmax.first;
+	stats.max = *minmax.second;
+	stats.median = Median(samples);
+	stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+	std::vector<double> deviations(samples.size());
+	for (size_t i = 0; i < samples.size(); ++i)
+		deviations[i] = std::abs(samples[i] - stats.median);
+	stats.mad = Median(deviations);
+
+	if (samples.size() > 1) {
+		double sumSquares = 0.0;
+		for (double sample : samples)
+			sumSquares += (sample - stats.mean) * (sample - stats.mean);
+		stats.stddev = std::sqrt(sumSquares / (samples.size() - 1));
+
+		const double halfWidth = StudentT975(samples.size() - 1) * stats.stddev / std::sqrt(static_cast<double>(samples.size()));
+		stats.ciLow = stats.mean - halfWidth;
+		stats.ciHigh = stats.mean + halfWidth;
+	}
+	else {
+		stats.ciLow = stats.ciHigh = stats.mean;
+	}
+
+	stats.cv = stats.mean != 0.0 ? stats.stddev / stats.mean : 0.0;
+
+	/* 1.4826 * MAD estimates the standard deviation for normal data, 0.6745 = 1 / 1.4826 */
+	if (stats.mad > 0.0) {
+		for (size_t i = 0; i < samples.size(); ++i) {
+			if (0.6745 * deviations[i] / stats.mad > OUTLIER_THRESHOLD)
+				stats.outliers.push_back(i);
+		}
+	}
+
+	return stats;
+}
+
+double Statistics::Median(std::vector<double> values) {
+	if (values.empty())
+		return 0.0;
+
+	const size_t middle = values.size() / 2;
+	std::nth_element(values.begin(), values.begin() + middle, values.end());
+	double median = values[middle];
+	if (values.size() % 2 == 0) {
+		median = (median + *std::max_element(values.begin(), values.begin() + middle)) / 2.0;
+	}
+	return median;
+}
+
+double Statistics::StudentT975(size_t degreesOfFreedom) {
+	static const double table[] = {
+		0.0,    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+		2.228,  2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+		2.086,  2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+		2.042
+	};
+	constexpr size_t tableSize = sizeof(table) / sizeof(table[0]);
+
+	if (degreesOfFreedom == 0)
+		return 0.0;
+	if (degreesOfFreedom < tableSize)
+		return table[degreesOfFreedom];
+
+	/* Cornish-Fisher expansion around the normal quantile, within 1e-4 of the exact value from 30 degrees of freedom on */
+	const double z = 1.959963985;
+	const double z2 = z * z;
+	const double v = static_cast<double>(degreesOfFreedom);
+	return z
+		+ z * (z2 + 1.0) / (4.0 * v)
+		+ z * ((5.0 * z2 + 16.0) * z2 + 3.0) / (96.0 * v * v)
+		+ z * (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) / (384.0 * v * v * v)
+		+ z * ((((79.0 * z2 + 776.0) * z2 + 1482.0) * z2 - 1920.0) * z2 - 945.0) / (92160.0 * v * v * v * v);
+}
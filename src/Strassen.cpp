@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Strassen.hpp"
+
+void StrassenArena::Reserve(size_t floats) {
+	if (m_Buffer.Cols() >= floats)
+		return;
+	m_Buffer = Matrix<float>(1, floats);
+	m_Used = 0;
+}
+
+size_t StrassenArena::Capacity() const {
+	return m_Buffer.Cols();
+}
+
+size_t StrassenArena::BlockSize(size_t rows, size_t cols) {
+	return rows * Matrix<float>::PaddedColumns(cols);
+}
+
+MatrixView<float> StrassenArena::Allocate(size_t rows, size_t cols) {
+	const size_t floats = BlockSize(rows, cols);
+	if (m_Used + floats > m_Buffer.Cols())
+		throw std::runtime_error("Strassen arena exhausted, reserve WorkspaceSize() floats first");
+
+	/* Every block is a whole number of cache lines, so the next one stays aligned */
+	MatrixView<float> block(m_Buffer.Data() + m_Used, rows, cols, Matrix<float>::PaddedColumns(cols));
+	m_Used += floats;
+	return block;
+}
+
+size_t StrassenArena::Mark() const {
+	return m_Used;
+}
+
+void StrassenArena::Release(size_t mark) {
+	m_Used = mark;
+}
+
+int Strassen::RecursionDepth(size_t n, size_t cutoff) {
+	int depth = 0;
+	cutoff = std::max<size_t>(cutoff, 1);
+	while (n > cutoff) {
+		n = (n + 1) / 2;
+		++depth;
+	}
+	return depth;
+}
+
+size_t Strassen::WorkspaceSize(size_t n, size_t cutoff) {
+	const int depth = RecursionDepth(n, cutoff);
+	const size_t padded = ((n + (size_t(1) << depth) - 1) >> depth) << depth;
+
+	/* Two temporaries per level, only one chain of levels is live at a time */
+	size_t floats = padded != n ? 3 * StrassenArena::BlockSize(padded, padded) : 0;
+	for (size_t half = padded / 2; depth > 0 && half >= padded >> depth; half /= 2)
+		floats += 2 * StrassenArena::BlockSize(half, half);
+	return floats;
+}
+
+void Strassen::Multiply(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c,
+	size_t cutoff, StrassenArena& arena, const StrassenLeafMultiply& leaf)
+{
+	const size_t n = c.Rows();
+	const int depth = RecursionDepth(n, cutoff);
+	const size_t padded = ((n + (size_t(1) << depth) - 1) >> depth) << depth;
+	arena.Reserve(WorkspaceSize(n, cutoff));
+
+	const size_t mark = arena.Mark();
+	if (padded == n) {
+		Recurse(a, b, c, cutoff, arena, leaf);
+		arena.Release(mark);
+		return;
+	}
+
+	/* Zero pad to a size that halves evenly down to the cutoff; the padding contributes nothing to C */
+	MatrixView<float> paddedA = arena.Allocate(padded, padded);
+	MatrixView<float> paddedB = arena.Allocate(padded, padded);
+	MatrixView<float> paddedC = arena.Allocate(padded, padded);
+	for (size_t i = 0; i < padded; i++) {
+		float* rowA = paddedA.Row(i);
+		float* rowB = paddedB.Row(i);
+		if (i < n) {
+			std::copy(a.Row(i), a.Row(i) + n, rowA);
+			std::copy(b.Row(i), b.Row(i) + n, rowB);
+		}
+		std::fill(rowA + (i < n ? n : 0), rowA + padded, 0.0f);
+		std::fill(rowB + (i < n ? n : 0), rowB + padded, 0.0f);
+	}
+
+	Recurse(paddedA, paddedB, paddedC, cutoff, arena, leaf);
+	for (size_t i = 0; i < n; i++)
+		std::copy(paddedC.Row(i), paddedC.Row(i) + n, c.Row(i));
+	arena.Release(mark);
+}
+
+void Strassen::Recurse(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c,
+	size_t cutoff, StrassenArena& arena, const StrassenLeafMultiply& leaf)
+{
+	const size_t n = c.Rows();
+	if (n <= cutoff || n % 2 != 0) {
+		leaf(a, b, c);
+		return;
+	}
+
+	const size_t h = n / 2;
+	const MatrixView<const float> a11 = a.Block(0, 0, h, h), a12 = a.Block(0, h, h, h);
+	const MatrixView<const float> a21 = a.Block(h, 0, h, h), a22 = a.Block(h, h, h, h);
+	const MatrixView<const float> b11 = b.Block(0, 0, h, h), b12 = b.Block(0, h, h, h);
+	const MatrixView<const float> b21 = b.Block(h, 0, h, h), b22 = b.Block(h, h, h, h);
+	const MatrixView<float> c11 = c.Block(0, 0, h, h), c12 = c.Block(0, h, h, h);
+	const MatrixView<float> c21 = c.Block(h, 0, h, h), c22 = c.Block(h, h, h, h);
+
+	const size_t mark = arena.Mark();
+	const MatrixView<float> x = arena.Allocate(h, h);
+	const MatrixView<float> y = arena.Allocate(h, h);
+
+	/* S and T are the Winograd sums of A and B blocks, P the seven products, U the partial results */
+	Subtract(a11, a21, x);                        // S3 = A11 - A21
+	Subtract(b22, b12, y);                        // T3 = B22 - B12
+	Recurse(x, y, c21, cutoff, arena, leaf);      // P7 = S3 T3
+	Add(a21, a22, x);                             // S1 = A21 + A22
+	Subtract(b12, b11, y);                        // T1 = B12 - B11
+	Recurse(x, y, c22, cutoff, arena, leaf);      // P5 = S1 T1
+	Subtract(x, a11, x);                          // S2 = S1 - A11
+	Subtract(b22, y, y);                          // T2 = B22 - T1
+	Recurse(x, y, c12, cutoff, arena, leaf);      // P6 = S2 T2
+	Subtract(a12, x, x);                          // S4 = A12 - S2
+	Recurse(x, b22, c11, cutoff, arena, leaf);    // P3 = S4 B22
+	Recurse(a11, b11, x, cutoff, arena, leaf);    // P1 = A11 B11
+	Add(x, c12, c12);                             // U2 = P1 + P6
+	Add(c12, c21, c21);                           // U3 = U2 + P7
+	Add(c12, c22, c12);                           // U4 = U2 + P5
+	Add(c21, c22, c22);                           // U7 = U3 + P5 = C22
+	Add(c12, c11, c12);                           // U5 = U4 + P3 = C12
+	Subtract(y, b21, y);                          // T4 = T2 - B21
+	Recurse(a22, y, c11, cutoff, arena, leaf);    // P4 = A22 T4
+	Subtract(c21, c11, c21);                      // U6 = U3 - P4 = C21
+	Recurse(a12, b21, c11, cutoff, arena, leaf);  // P2 = A12 B21
+	Add(x, c11, c11);                             // U1 = P1 + P2 = C11
+
+	arena.Release(mark);
+}
+
+void Strassen::Add(MatrixView<const float> x, MatrixView<const float> y, MatrixView<float> out) {
+	for (size_t i = 0; i < out.Rows(); i++) {
+		const float* rowX = x.Row(i);
+		const float* rowY = y.Row(i);
+		float* row = out.Row(i);
+		for (size_t j = 0; j < out.Cols(); j++)
+			row[j] = rowX[j] + rowY[j];
+	}
+}
+
+void Strassen::Subtract(MatrixView<const float> x, MatrixView<const float> y, MatrixView<float> out) {
+	for (size_t i = 0; i < out.Rows(); i++) {
+		const float* rowX = x.Row(i);
+		const float* rowY = y.Row(i);
+		float* row = out.Row(i);
+		for (size_t j = 0; j < out.Cols(); j++)
+			row[j] = rowX[j] - rowY[j];
+	}
+}
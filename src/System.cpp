@@ -22,6 +22,8 @@
 	#include <sstream>
 	#ifdef __APPLE__
 		#include <sys/sysctl.h>
+	#else
+		#include <sched.h>
 	#endif
 #else
 	#error "Unsupported Platform"
@@ -166,4 +168,39 @@ int64_t SystemDetector::GetTotalPhysRAM() {
 	LOG_ERROR("Could not find MemTotal in /proc/meminfo");
 	return 0;
 #endif
-}
\ No newline at end of file
+}
+
+std::vector<CpuTopology> SystemDetector::GetCpuTopology() {
+	std::vector<CpuTopology> topology;
+
+#if defined(__linux__)
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+		LOG_ERROR("Failed to read the process CPU affinity mask");
+		CPU_ZERO(&allowed);
+		for (int cpu = 0; cpu < GetNumCores() && cpu < CPU_SETSIZE; ++cpu)
+			CPU_SET(cpu, &allowed);
+	}
+
+	auto readTopologyValue = [](int cpu, const std::string& name, int fallback) {
+		std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+		int value;
+		if (file >> value)
+			return value;
+		return fallback;
+	};
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+		if (!CPU_ISSET(cpu, &allowed))
+			continue;
+		topology.push_back({ cpu, readTopologyValue(cpu, "core_id", cpu), readTopologyValue(cpu, "physical_package_id", 0) });
+	}
+#else
+	/* No portable topology source, treat every logical CPU as its own core */
+	for (int cpu = 0; cpu < GetNumCores(); ++cpu)
+		topology.push_back({ cpu, cpu, 0 });
+#endif
+
+	return topology;
+}
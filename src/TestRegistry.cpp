@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <utility>
+
+#include "TestRegistry.hpp"
+
+std::vector<TestInfo>& TestRegistry::Entries() {
+	/* Function-local, so registrations from any translation unit find it constructed */
+	static std::vector<TestInfo> entries;
+	return entries;
+}
+
+bool TestRegistry::Register(TestInfo info) {
+	std::vector<TestInfo>& entries = Entries();
+	auto it = std::find_if(entries.begin(), entries.end(), [&](const TestInfo& entry) { return entry.name == info.name; });
+	if (it != entries.end())
+		*it = std::move(info);
+	else
+		entries.push_back(std::move(info));
+	return true;
+}
+
+bool TestRegistry::Register(std::string name, TestCategory category, unsigned modes, std::string description,
+	TestFactory factory, TestParams defaults)
+{
+	TestInfo info;
+	info.name = std::move(name);
+	info.category = category;
+	info.modes = modes;
+	info.description = std::move(description);
+	info.factory = std::move(factory);
+	info.defaults = defaults;
+	return Register(std::move(info));
+}
+
+const TestInfo* TestRegistry::Find(const std::string& name) {
+	for (const TestInfo& entry : Entries()) {
+		if (entry.name == name)
+			return &entry;
+	}
+	return nullptr;
+}
+
+std::unique_ptr<BenchmarkTest> TestRegistry::Create(const std::string& name, const TestParams& params) {
+	const TestInfo* info = Find(name);
+	if (info == nullptr || !info->factory)
+		return nullptr;
+	return info->factory(ApplyDefaults(params, info->defaults));
+}
+
+TestParams TestRegistry::ApplyDefaults(const TestParams& params, const TestParams& defaults) {
+	TestParams resolved = params;
+	if (!(params.explicitParams & TEST_PARAM_MATRIX_SIZE))
+		resolved.matrixSize = defaults.matrixSize;
+	if (!(params.explicitParams & TEST_PARAM_STRASSEN_CUTOFF))
+		resolved.strassenCutoff = defaults.strassenCutoff;
+	if (!(params.explicitParams & TEST_PARAM_SPARSE_SIZE))
+		resolved.sparse.size = defaults.sparse.size;
+	if (!(params.explicitParams & TEST_PARAM_SPARSE_DENSITY))
+		resolved.sparse.density = defaults.sparse.density;
+	if (!(params.explicitParams & TEST_PARAM_SPARSE_PATTERN))
+		resolved.sparse.pattern = defaults.sparse.pattern;
+	return resolved;
+}
+
+std::vector<const TestInfo*> TestRegistry::List() {
+	std::vector<const TestInfo*> list;
+	for (const TestInfo& entry : Entries())
+		list.push_back(&entry);
+	std::sort(list.begin(), list.end(), [](const TestInfo* a, const TestInfo* b) { return a->name < b->name; });
+	return list;
+}
+
+std::string TestRegistry::CategoryToString(TestCategory category) {
+	switch (category) {
+	case TestCategory::GEMM:	return "gemm";
+	case TestCategory::SPARSE:	return "sparse";
+	case TestCategory::SCALAR:	return "scalar";
+	default:					return "unknown";
+	}
+}
+
+TestCategory TestRegistry::StringToCategory(const std::string& categoryStr) {
+	if (categoryStr == "gemm")			return TestCategory::GEMM;
+	else if (categoryStr == "sparse")	return TestCategory::SPARSE;
+	else								return TestCategory::SCALAR;
+}
+
+std::string TestRegistry::ModesToString(unsigned modes) {
+	static const std::pair<TestMode, const char*> names[] = {
+		{ TEST_MODE_SINGLE_THREADED, "single" },
+		{ TEST_MODE_MULTI_THREADED, "multi" },
+		{ TEST_MODE_LATENCY, "latency" },
+		{ TEST_MODE_OPEN_LOOP, "open-loop" },
+		{ TEST_MODE_MATRIX_SWEEP, "sweep" },
+	};
+
+	std::string result;
+	for (const auto& [mode, name] : names) {
+		if (modes & mode)
+			result += (result.empty() ? "" : "|") + std::string(name);
+	}
+	return result;
+}
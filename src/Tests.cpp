@@ -1,45 +1,107 @@
+#include <algorithm>
 #include <cstdlib>
 #include <functional>
 #include <random>
 #include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
 #include <numeric>
+#include <sstream>
 
+#include "Gemm.hpp"
 #include "Logger.hpp"
 #include "Tests.hpp"
+#include "TestRegistry.hpp"
 #include "System.hpp"
+#include "Timer.hpp"
+
+/*
+ * Run modes of every built-in test. The scalar tests get each path from
+ * BatchedTest; the dense and sparse products split one product over the
+ * pool in RunMultiThreaded, time each product for latency runs and give
+ * every open-loop worker an output of its own.
+ */
+static constexpr unsigned BUILTIN_TEST_MODES = TEST_MODE_SINGLE_THREADED | TEST_MODE_MULTI_THREADED | TEST_MODE_LATENCY | TEST_MODE_OPEN_LOOP;
+/* The dense products are built from params.matrixSize, so the matrix sweep can rebuild them at every size */
+static constexpr unsigned GEMM_TEST_MODES = BUILTIN_TEST_MODES | TEST_MODE_MATRIX_SWEEP;
 
 /* Integer Arithmetic Test Class */
 IntegerArithmeticTest::IntegerArithmeticTest() 
-	: BenchmarkTest("integer_arithmetic_test") {}
+	: BatchedTest("integer_arithmetic_test") {}
+
+REGISTER_BENCHMARK("integer_arithmetic_test", TestCategory::SCALAR, BUILTIN_TEST_MODES,
+	"64-bit multiply, add, xor and rotate chains on random operands",
+	[](const TestParams&) { return std::make_unique<IntegerArithmeticTest>(); });
 
 void IntegerArithmeticTest::Run() {
-	int64_t result = 0;
-	/* Loop unrolling for better pipeline utilization */
-	for (size_t i = 0; i < ITERATION_COUNT; i += 4) {
+	/* Same body as the threaded runs, so both do INT_OPS_PER_ITERATION per iteration and Verify checks what was timed */
+	RunIterations(0, m_IterationCount, GetThreadContext(0));
+}
+
+void IntegerArithmeticTest::SetUp() {
+	Xoshiro256 gen = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM);
+	std::uniform_int_distribution<int64_t> dist(0, RAND_MAX);
+	m_Inputs.resize(TEST_INPUT_COUNT * 2);
+	for (int64_t& input : m_Inputs)
+		input = dist(gen);
+}
+
+void IntegerArithmeticTest::TearDown() {
+	m_Inputs = std::vector<int64_t>();
+}
+
+uint64_t IntegerArithmeticTest::Iteration(ThreadContext& context) {
+	/* Operands are picked through the thread's own stream, so threads neither share generator state nor walk in lockstep */
+	const size_t cursor = 2 * context.random.NextBelow(static_cast<uint32_t>(m_Inputs.size() / 2));
+
+	uint64_t result = 0;
+	result += (m_Inputs[cursor] * (m_Inputs[cursor + 1] + 1)) / 2;
+	result += PerformOperations(result);
+	return result;
+}
+
+WorkPerIteration IntegerArithmeticTest::GetWork() const {
+	WorkPerIteration work;
+	work.unit = WorkUnit::INT_OP;
+	work.amount = INT_OPS_PER_ITERATION;
+	return work;
+}
+
+void IntegerArithmeticTest::Verify() {
+	ExpectEqual("checksum of " + std::to_string(VERIFY_ITERATIONS) + " iterations", Accumulate(VERIFY_ITERATIONS), VERIFY_CHECKSUM);
+
+	/* The timed kernel on a fixed operand table and stream, so the answer does not depend on the run's seed */
+	std::vector<int64_t> inputs(TEST_INPUT_COUNT * 2);
+	for (size_t j = 0; j < inputs.size(); j++)
+		inputs[j] = static_cast<int64_t>((j * 0x9E3779B1ull) & MASK);
+	std::swap(m_Inputs, inputs);
+
+	ThreadContext context;
+	context.random = Xoshiro256(VERIFY_SEED);
+	uint64_t checksum = 0;
+	for (int64_t i = 0; i < VERIFY_ITERATIONS; i++)
+		checksum += Iteration(context);
+	std::swap(m_Inputs, inputs);
+
+	ExpectEqual("checksum of " + std::to_string(VERIFY_ITERATIONS) + " timed iterations",
+		static_cast<int64_t>(checksum), static_cast<int64_t>(VERIFY_ITERATION_CHECKSUM));
+}
+
+int64_t IntegerArithmeticTest::Accumulate(int64_t iterations) {
+	/* Unsigned, so the wraparound is defined; loop unrolling for better pipeline utilization */
+	uint64_t result = 0;
+	for (int64_t i = 0; i < iterations; i += 4) {
 		result += (static_cast<int64_t>(i) * (i + 1)) / 2;
 		result += (static_cast<int64_t>(i) * (i + 2)) / 2;
 		result += (static_cast<int64_t>(i) * (i + 3)) / 2;
 		result += (static_cast<int64_t>(i) * (i + 4)) / 2;
 		result = PerformOperations(result);
 	}
-
-	volatile int64_t prevent_optimization = result;
-	if (!prevent_optimization) {
-		LOG_ERROR("Integer arithmetic test result is 0.");
-		throw BenchmarkException("Unexpected result in Integer Arithmetic Test");
-	}
-}
-
-void IntegerArithmeticTest::RunSingleIteration() {
-	static std::mt19937 gen(std::random_device{}());
-	static std::uniform_int_distribution<int64_t> dist(0, RAND_MAX);
-
-	int64_t result = 0;
-	result += (dist(gen) * (dist(gen) + 1)) / 2;
-	result += PerformOperations(result);
+	return static_cast<int64_t>(result);
 }
 
-int64_t IntegerArithmeticTest::PerformOperations(int64_t result) {
+uint64_t IntegerArithmeticTest::PerformOperations(uint64_t result) {
 	result = (result * MULTIPLIER + INCREMENT) ^ MASK;
 	result = (result >> 4) | (result << (64 - 4));
 	return result;
@@ -48,38 +110,121 @@ int64_t IntegerArithmeticTest::PerformOperations(int64_t result) {
 
 /* Floating Point Test Class */
 FloatingPointTest::FloatingPointTest()
-	: BenchmarkTest("floating_point_test") {}
+	: BatchedTest("floating_point_test") {}
+
+REGISTER_BENCHMARK("floating_point_test", TestCategory::SCALAR, BUILTIN_TEST_MODES,
+	"Transcendental libm calls on random double operands",
+	[](const TestParams&) { return std::make_unique<FloatingPointTest>(); });
 
 void FloatingPointTest::Run() {
-	benchmark_float_type result = 0.0;
-	result += BasicArithmeticTest();
-	result += TranscendentalTest();
-	result += SpecialCasesTest();
-	result += PrecisionTest();
+	/* Same transcendental mix as the threaded runs, so both score the kernel Verify checks */
+	RunIterations(0, m_IterationCount, GetThreadContext(0));
+}
 
-	volatile benchmark_float_type check = result;
-	if (std::isnan(check) || std::isinf(check) || !check) {
-		LOG_ERROR("Floating point arithmetic test failed.");
-		throw BenchmarkException("Invalid result in Floating Point Test");
+void FloatingPointTest::SetUp() {
+	/* x is the base of pow(x, 0.5), so it stays non-negative; y keeps both signs */
+	Xoshiro256 gen = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM);
+	std::uniform_real_distribution<benchmark_float_type> base(0.0, 1000.0);
+	std::uniform_real_distribution<benchmark_float_type> dis(-1000.0, 1000.0);
+	m_Inputs.resize(TEST_INPUT_COUNT * 2);
+	for (size_t j = 0; j < m_Inputs.size(); j += 2) {
+		m_Inputs[j] = base(gen);
+		m_Inputs[j + 1] = dis(gen);
 	}
 }
 
-void FloatingPointTest::RunSingleIteration() {
-	static std::mt19937 gen(std::random_device{}());
-	static std::uniform_real_distribution<benchmark_float_type> dis(-1000.0, 1000.0);
+void FloatingPointTest::TearDown() {
+	m_Inputs = std::vector<benchmark_float_type>();
+}
+
+benchmark_float_type FloatingPointTest::Iteration(ThreadContext& context) {
+	const size_t cursor = 2 * context.random.NextBelow(static_cast<uint32_t>(m_Inputs.size() / 2));
 
-	benchmark_float_type x = dis(gen);
-	benchmark_float_type y = dis(gen);
+	benchmark_float_type x = m_Inputs[cursor];
+	benchmark_float_type y = m_Inputs[cursor + 1];
 
-	volatile benchmark_float_type result = 0.0;
+	benchmark_float_type result = 0.0;
 	result += std::sin(x) * std::cos(y) - std::tan(x + y);
 	result += std::exp(std::fmod(x, 5.0)) + std::log1p(std::abs(x));
 	result += std::sqrt(std::abs(x * y)) * std::pow(x, 0.5);
+	return result;
+}
+
+WorkPerIteration FloatingPointTest::GetWork() const {
+	WorkPerIteration work;
+	work.unit = WorkUnit::ITEM;
+	work.amount = MATH_CALLS_PER_ITERATION;
+	work.itemName = "math call";
+	return work;
+}
+
+void FloatingPointTest::Verify() {
+	/* Sum over i of 2x - x^2 with x = i / 10 */
+	const double n = static_cast<double>(VERIFY_ITERATIONS);
+	const double sumI = n * (n - 1.0) / 2.0;
+	const double sumI2 = (n - 1.0) * n * (2.0 * n - 1.0) / 6.0;
+	ExpectNear("basic arithmetic sum", BasicArithmeticTest(VERIFY_ITERATIONS), 0.2 * sumI - 0.01 * sumI2,
+		VERIFY_TOLERANCE * (0.2 * sumI + 0.01 * sumI2));
+
+	long double reference = 0.0L;
+	long double magnitude = 0.0L;
+	for (int64_t i = 0; i < VERIFY_ITERATIONS; ++i) {
+		/* Same double input as the kernel, so fmod lands on the same side of every multiple of 5 */
+		const long double x = static_cast<double>(i) * 0.1;
+		const long double terms[] = {
+			std::sin(x) * std::cos(x), std::tanh(x), std::exp2(std::fmod(x, 5.0L)), std::log1p(x), std::sqrt(x) * std::erf(x)
+		};
+		for (long double term : terms) {
+			reference += term;
+			magnitude += std::abs(term);
+		}
+	}
+	ExpectNear("transcendental sum", TranscendentalTest(VERIFY_ITERATIONS), static_cast<double>(reference),
+		VERIFY_TOLERANCE * static_cast<double>(magnitude));
+
+	/* Sum of (1 + 10^-i) - 1 for i = 1..100, the terms vanish once 10^-i drops below the epsilon */
+	ExpectNear("precision sum", PrecisionTest(), 1.0 / 9.0, 1e-12);
+
+	/* The timed kernel on a fixed operand table and stream, against the same picks evaluated in long double */
+	std::vector<benchmark_float_type> inputs(TEST_INPUT_COUNT * 2);
+	for (size_t j = 0; j < inputs.size(); j += 2) {
+		inputs[j] = static_cast<benchmark_float_type>(j % 1000) * 0.37;
+		inputs[j + 1] = static_cast<benchmark_float_type>(static_cast<int64_t>(j * 7 % 2000) - 1000) * 0.29;
+	}
+
+	ThreadContext context;
+	context.random = Xoshiro256(VERIFY_SEED);
+	Xoshiro256 picks(VERIFY_SEED);
+	double sum = 0.0;
+	long double iterationReference = 0.0L;
+	long double iterationMagnitude = 0.0L;
+	std::swap(m_Inputs, inputs);
+	for (int64_t i = 0; i < VERIFY_ITERATIONS; ++i) {
+		sum += Iteration(context);
+
+		const size_t cursor = 2 * picks.NextBelow(static_cast<uint32_t>(m_Inputs.size() / 2));
+		const long double x = m_Inputs[cursor];
+		const long double y = m_Inputs[cursor + 1];
+		/* Sum and product rounded to double as in the kernel, tan is too steep near its poles to compare otherwise */
+		const long double sumXY = static_cast<double>(m_Inputs[cursor] + m_Inputs[cursor + 1]);
+		const long double productXY = static_cast<double>(m_Inputs[cursor] * m_Inputs[cursor + 1]);
+		const long double terms[] = {
+			std::sin(x) * std::cos(y), -std::tan(sumXY), std::exp(std::fmod(x, 5.0L)), std::log1p(std::abs(x)),
+			std::sqrt(std::abs(productXY)) * std::pow(x, 0.5L)
+		};
+		for (long double term : terms) {
+			iterationReference += term;
+			iterationMagnitude += std::abs(term);
+		}
+	}
+	std::swap(m_Inputs, inputs);
+	ExpectNear("sum of " + std::to_string(VERIFY_ITERATIONS) + " timed iterations", sum, static_cast<double>(iterationReference),
+		VERIFY_TOLERANCE * static_cast<double>(iterationMagnitude));
 }
 
-benchmark_float_type FloatingPointTest::BasicArithmeticTest() {
+benchmark_float_type FloatingPointTest::BasicArithmeticTest(int64_t iterations) {
 	benchmark_float_type result = 0.0;
-	for (int i = 0; i < m_IterationCount; i += 4) {
+	for (int64_t i = 0; i < iterations; i += 4) {
 		benchmark_float_type x1 = i * 0.1, x2 = (i+1) * 0.1, x3 = (i+2) * 0.1, x4 = (i+3) * 0.1;
 		result += x1 + x1 - x1 * x1;
 		result += x2 + x2 - x2 * x2;
@@ -89,9 +234,9 @@ benchmark_float_type FloatingPointTest::BasicArithmeticTest() {
 	return result;
 }
 
-benchmark_float_type FloatingPointTest::TranscendentalTest() {
+benchmark_float_type FloatingPointTest::TranscendentalTest(int64_t iterations) {
 	benchmark_float_type result = 0.0;
-	for (int i = 0; i < m_IterationCount; ++i) {
+	for (int64_t i = 0; i < iterations; ++i) {
 		benchmark_float_type x = static_cast<benchmark_float_type>(i) * 0.1;
 		result += std::sin(x) * std::cos(x) + std::tanh(x);
 		result += std::exp2(std::fmod(x, 5.0)) + std::log1p(x);
@@ -100,28 +245,6 @@ benchmark_float_type FloatingPointTest::TranscendentalTest() {
 	return result;
 }
 
-benchmark_float_type FloatingPointTest::SpecialCasesTest() {
-	std::array<benchmark_float_type, 8> specialValues = {
-		0.0,
-		std::numeric_limits<benchmark_float_type>::epsilon(),
-		std::numeric_limits<benchmark_float_type>::min(),
-		std::numeric_limits<benchmark_float_type>::denorm_min(),
-		std::numeric_limits<benchmark_float_type>::max(),
-		std::numeric_limits<benchmark_float_type>::infinity(),
-		-std::numeric_limits<benchmark_float_type>::infinity(),
-		std::numeric_limits<benchmark_float_type>::quiet_NaN()
-	};
-
-	benchmark_float_type result = 0.0;
-	for (auto val : specialValues) {
-		result += std::isfinite(val) ? val : 0.0;
-		result += std::isnormal(val) ? 1.0 : 0.0;
-		result += std::fpclassify(val) * 0.1;
-		result += std::copysign(1.0, val);
-	}
-	return result;
-}
-
 benchmark_float_type FloatingPointTest::PrecisionTest() {
 	benchmark_float_type result = 0.0;
 	benchmark_float_type small = 1.0;
@@ -137,19 +260,46 @@ benchmark_float_type FloatingPointTest::PrecisionTest() {
 
 /* Prime Test Class */
 PrimeTest::PrimeTest()
-	: BenchmarkTest("prime_calculation_test") {}
+	: BatchedTest("prime_calculation_test") {}
+
+REGISTER_BENCHMARK("prime_calculation_test", TestCategory::SCALAR, BUILTIN_TEST_MODES,
+	"Trial division primality of random integers",
+	[](const TestParams&) { return std::make_unique<PrimeTest>(); });
 
 void PrimeTest::Run() {
-	int count = 0;
-	for (int i = 2; i < m_IterationCount; ++i) {
-		if (isPrime(i)) ++count;
-	}
+	/* The random inputs of the threaded runs, so an iteration costs the same on every path and calibration can scale it */
+	RunIterations(0, m_IterationCount, GetThreadContext(0));
+}
+
+void PrimeTest::SetUp() {
+	Xoshiro256 gen = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM);
+	std::uniform_int_distribution<int> dist(0, RAND_MAX);
+	m_Inputs.resize(TEST_INPUT_COUNT);
+	for (int& input : m_Inputs)
+		input = dist(gen);
+}
 
-	volatile int check = count;
+void PrimeTest::TearDown() {
+	m_Inputs = std::vector<int>();
 }
 
-void PrimeTest::RunSingleIteration() {
-	isPrime(rand());
+int PrimeTest::Iteration(ThreadContext& context) {
+	return isPrime(m_Inputs[context.random.NextBelow(static_cast<uint32_t>(m_Inputs.size()))]) ? 1 : 0;
+}
+
+WorkPerIteration PrimeTest::GetWork() const {
+	WorkPerIteration work;
+	work.unit = WorkUnit::ITEM;
+	work.itemName = "number tested";
+	return work;
+}
+
+void PrimeTest::Verify() {
+	int count = 0;
+	for (int i = 2; i < VERIFY_LIMIT; ++i) {
+		if (isPrime(i)) ++count;
+	}
+	ExpectEqual("number of primes below " + std::to_string(VERIFY_LIMIT), count, VERIFY_PRIME_COUNT);
 }
 
 bool PrimeTest::isPrime(int n) {
@@ -157,153 +307,556 @@ bool PrimeTest::isPrime(int n) {
 	if (n <= 3) return true;
 	if ((n % 2) == 0 || n % 3 == 0) return false;
 
-	for (int i = 5; i * i < n; i += 6)
+	for (int i = 5; i * i <= n; i += 6)
 		if (n % i == 0 || n % (i + 2) == 0)
 			return false;
 	
 	return true;
 }
 
-MatrixMultiplicationTest::MatrixMultiplicationTest() 
-	: BenchmarkTest("matrix_multiplication_test") {}
+namespace {
+	/* Values in [0, 1) for the floating point types, the full range for the integer ones */
+	template<typename T>
+	T RandomElement(Xoshiro256& gen) {
+		return static_cast<T>(std::uniform_real_distribution<double>(0.0, 1.0)(gen));
+	}
 
-void MatrixMultiplicationTest::Run() {
-	RunSingleIteration();
-}
+	template<>
+	Float16 RandomElement<Float16>(Xoshiro256& gen) {
+		return ToFloat16(std::uniform_real_distribution<float>(0.0f, 1.0f)(gen));
+	}
 
-void MatrixMultiplicationTest::RunMultiThreaded(int numThreads) {
-	const int matrix_size = 512;
-	std::vector<std::vector<float>> a(matrix_size, std::vector<float>(matrix_size));
-	std::vector<std::vector<float>> b(matrix_size, std::vector<float>(matrix_size));
-	std::vector<std::vector<float>> c(matrix_size, std::vector<float>(matrix_size));
+	template<>
+	BFloat16 RandomElement<BFloat16>(Xoshiro256& gen) {
+		return ToBFloat16(std::uniform_real_distribution<float>(0.0f, 1.0f)(gen));
+	}
 
-	_InitializeMatrix(a);
-	_InitializeMatrix(b);
+	template<>
+	uint8_t RandomElement<uint8_t>(Xoshiro256& gen) {
+		return static_cast<uint8_t>(std::uniform_int_distribution<int>(0, 255)(gen));
+	}
 
-	if constexpr (hasAVX2ctime) {
-		if (check_avx2()) {
-			LOG_INFO("Using _AVX2MultiplicationMultiThread. (line 185)");
-			_AVX2MultiplicationMultiThread(a, b, c);
-		}
+	template<>
+	int8_t RandomElement<int8_t>(Xoshiro256& gen) {
+		return static_cast<int8_t>(std::uniform_int_distribution<int>(-128, 127)(gen));
 	}
-	else {
-		LOG_INFO("Using _BasicMultiplicationMultiThread. (line 190)");
-		_BasicMultiplicationMultiThread(a, b, c);
+
+	/* Exact value of an operand or result element, for the scalar references */
+	template<typename T>
+	double ToDouble(T value) {
+		return static_cast<double>(value);
 	}
+
+	template<>
+	double ToDouble<Float16>(Float16 value) {
+		return ToFloat(value);
+	}
+
+	template<>
+	double ToDouble<BFloat16>(BFloat16 value) {
+		return ToFloat(value);
+	}
+}
+
+/* GEMM Test Class Template */
+template<typename TA, typename TB, typename TC>
+GemmTest<TA, TB, TC>::GemmTest(const std::string& testName, size_t matrixSize)
+	: BenchmarkTest(testName),
+	m_MatrixSize(matrixSize)
+{
+	/* One iteration is a full matrix product */
+	m_IterationCount = 1;
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::SetUp() {
+	m_A = Matrix<TA>(m_MatrixSize, m_MatrixSize);
+	m_B = Matrix<TB>(m_MatrixSize, m_MatrixSize);
+	m_C = Matrix<TC>(m_MatrixSize, m_MatrixSize);
+
+	Xoshiro256 random = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM);
+	_InitializeMatrix(m_A, random);
+	_InitializeMatrix(m_B, random);
+	Engine::PrepareB(m_MatrixSize, m_MatrixSize, m_PackedB);
+	_ReservePackingBuffers();
+	LOG_DEBUG(m_Name + " uses packed GEMM with the " + Engine::GetKernelName() + " microkernel.");
 }
 
-void MatrixMultiplicationTest::RunSingleIteration() {
-	const int matrix_size = 512;
-	std::vector<std::vector<float>> a(matrix_size, std::vector<float>(matrix_size));
-	std::vector<std::vector<float>> b(matrix_size, std::vector<float>(matrix_size));
-	std::vector<std::vector<float>> c(matrix_size, std::vector<float>(matrix_size));
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::ResetTrial() {
+	const TC poison = std::numeric_limits<TC>::has_quiet_NaN ? std::numeric_limits<TC>::quiet_NaN() : std::numeric_limits<TC>::max();
+	for (size_t i = 0; i < m_C.Rows(); i++)
+		std::fill(m_C.Row(i), m_C.Row(i) + m_C.Cols(), poison);
+}
 
-	_InitializeMatrix(a);
-	_InitializeMatrix(b);
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::SetUpOpenLoop(int numThreads) {
+	/* Allocated here rather than on a worker's first request, and only for open-loop runs: n^2 per worker adds up at large sizes */
+	while (static_cast<int>(m_WorkerC.size()) < numThreads)
+		m_WorkerC.emplace_back(m_MatrixSize, m_MatrixSize);
+}
 
-	if constexpr (hasAVX2ctime) {
-		if (check_avx2()) {
-			LOG_INFO("Using _AVX2MultiplicationSingleThread. (line 206)");
-			_AVX2MultiplicationSingleThread(a, b, c, 0, matrix_size);
-		}
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::TearDown() {
+	m_A = Matrix<TA>();
+	m_B = Matrix<TB>();
+	m_C = Matrix<TC>();
+	m_PackedB = GemmPackedB<typename Engine::PackedB>();
+	m_WorkerC = std::vector<Matrix<TC>>();
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::Run() {
+	for (int64_t iter = 0; iter < m_IterationCount; ++iter)
+		Engine::Multiply(m_A, m_B, m_C, 0, m_MatrixSize);
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::RunMultiThreaded(int numThreads) {
+	/* Every iteration is one parallel product, timed as a whole into the first histogram */
+	if (m_RecordLatency)
+		PrepareLatencyHistograms(1);
+
+	for (int64_t iter = 0; iter < m_IterationCount; ++iter) {
+		const Timer::Stamp start = Timer::Start();
+		_GemmMultiThread(m_A, m_B, m_C, numThreads);
+		if (m_RecordLatency)
+			m_LatencyHistograms[0].Record(Timer::Elapsed(start, Timer::Stop()).nanoseconds);
 	}
-	else {
-		LOG_INFO("Using _BasicMultiplicationSingleThread. (line 211)");
-		_BasicMultiplicationSingleThread(a, b, c, 0, matrix_size);
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::RunSingleIteration(ThreadContext& context) {
+	/* Open-loop workers call this concurrently, so each thread multiplies into its own product */
+	Engine::Multiply(m_A, m_B, m_WorkerC[context.threadIndex], 0, m_MatrixSize);
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::Verify() {
+	const size_t n = m_MatrixSize;
+	const size_t samples = std::min<size_t>(n, VERIFY_SAMPLE_ROWS);
+	const double unitRoundoff = std::numeric_limits<TC>::epsilon();
+
+	std::vector<double> reference(n), magnitude(n);
+	for (size_t s = 0; s < samples; s++) {
+		const size_t i = samples > 1 ? s * (n - 1) / (samples - 1) : 0;
+		std::fill(reference.begin(), reference.end(), 0.0);
+		std::fill(magnitude.begin(), magnitude.end(), 0.0);
+
+		const TA* a = m_A.Row(i);
+		for (size_t k = 0; k < n; k++) {
+			const double aik = ToDouble(a[k]);
+			const TB* b = m_B.Row(k);
+			for (size_t j = 0; j < n; j++) {
+				const double product = aik * ToDouble(b[j]);
+				reference[j] += product;
+				magnitude[j] += std::abs(product);
+			}
+		}
+
+		const TC* c = m_C.Row(i);
+		for (size_t j = 0; j < n; j++) {
+			const double tolerance = n * unitRoundoff * magnitude[j];
+			if (!NearlyEqual(ToDouble(c[j]), reference[j], tolerance))
+				ExpectNear("C(" + std::to_string(i) + ", " + std::to_string(j) + ")", ToDouble(c[j]), reference[j], tolerance);
+		}
 	}
 }
 
-void MatrixMultiplicationTest::_InitializeMatrix(std::vector<std::vector<float>>& m) {
-	static std::mt19937 gen(std::random_device{}());
-	static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
-	for (auto& row : m) {
-		for (auto& val : row) {
-			val = dis(gen);
+template<typename TA, typename TB, typename TC>
+size_t GemmTest<TA, TB, TC>::GetMatrixSize() const {
+	return m_MatrixSize;
+}
+
+template<typename TA, typename TB, typename TC>
+WorkPerIteration GemmTest<TA, TB, TC>::GetWork() const {
+	const double n = static_cast<double>(m_MatrixSize);
+	WorkPerIteration work;
+	work.unit = WorkUnit::FLOP;
+	work.amount = 2.0 * n * n * n;
+	work.bytes = n * n * (sizeof(TA) + sizeof(TB) + sizeof(TC));
+	return work;
+}
+
+template<typename TA, typename TB, typename TC>
+template<typename T>
+void GemmTest<TA, TB, TC>::_InitializeMatrix(Matrix<T>& m, Xoshiro256& random) {
+	for (size_t i = 0; i < m.Rows(); i++) {
+		T* row = m.Row(i);
+		for (size_t j = 0; j < m.Cols(); j++) {
+			row[j] = RandomElement<T>(random);
 		}
 	}
 }
 
-void MatrixMultiplicationTest::_BasicMultiplicationSingleThread(
-								const std::vector<std::vector<float>>& a,
-								const std::vector<std::vector<float>>& b, 
-								std::vector<std::vector<float>>& c,
-								size_t startRow, size_t endRow)
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::_ReservePackingBuffers() {
+	/* The packing buffers belong to the threads, grow them on the caller and on every pool worker before timing */
+	const size_t n = m_MatrixSize;
+	Engine::ReserveThreadBuffers(n, n, n);
+	if (m_Pool != nullptr)
+		RunOnThreads(m_Pool->GetSize(), [n](int) { Engine::ReserveThreadBuffers(n, n, n); });
+}
+
+template<typename TA, typename TB, typename TC>
+void GemmTest<TA, TB, TC>::_GemmMultiThread(const Matrix<TA>& a, const Matrix<TB>& b, Matrix<TC>& c,
+	int numThreads)
 {
-	const size_t size = a.size();
-	for (size_t i = startRow; i < endRow; i++) {
-		for (size_t j = 0; j < size; j++) {
-			float sum = 0.0f;
-			for (size_t k = 0; k < size; k++) {
-				sum += a[i][k] * b[k][j];
-			}
-			c[i][j] = sum;
+	/* The pool packs B once together, then 2D tiles of C are handed out through per-thread deques and idle threads steal */
+	RunOnThreads(numThreads, [&](int t) {
+		Engine::PackSharedB(b, m_PackedB, static_cast<size_t>(t), static_cast<size_t>(numThreads));
+	});
+
+	const GemmTiling tiling = Engine::PlanTiles(c.Rows(), c.Cols(), numThreads);
+	WorkScheduler scheduler(ScheduleMode::STEALING, static_cast<int64_t>(tiling.Count()), numThreads, 1);
+	RunOnThreads(numThreads, [&](int t) {
+		int64_t begin = 0;
+		int64_t end = 0;
+		while (scheduler.NextChunk(t, begin, end)) {
+			for (int64_t tile = begin; tile < end; ++tile)
+				Engine::MultiplyTile(a, m_PackedB, c, tiling, static_cast<size_t>(tile));
 		}
-	}
+	});
 }
 
-void MatrixMultiplicationTest::_BasicMultiplicationMultiThread(
-								const std::vector<std::vector<float>>& a,
-								const std::vector<std::vector<float>>& b, 
-								std::vector<std::vector<float>>& c)
+template class GemmTest<float, float, float>;
+template class GemmTest<double, double, double>;
+template class GemmTest<Float16, Float16, float>;
+template class GemmTest<BFloat16, BFloat16, float>;
+template class GemmTest<uint8_t, int8_t, int32_t>;
+
+MatrixMultiplicationTest::MatrixMultiplicationTest(size_t matrixSize)
+	: GemmTest("matrix_multiplication_test", matrixSize) {}
+
+REGISTER_BENCHMARK("matrix_multiplication_test", TestCategory::GEMM, GEMM_TEST_MODES,
+	"Packed FP32 GEMM of two matrix_size squared matrices",
+	[](const TestParams& params) { return std::make_unique<MatrixMultiplicationTest>(params.matrixSize); });
+
+MatrixMultiplicationFP64Test::MatrixMultiplicationFP64Test(size_t matrixSize)
+	: GemmTest("matrix_multiplication_fp64_test", matrixSize) {}
+
+REGISTER_BENCHMARK("matrix_multiplication_fp64_test", TestCategory::GEMM, GEMM_TEST_MODES,
+	"Packed FP64 GEMM of two matrix_size squared matrices",
+	[](const TestParams& params) { return std::make_unique<MatrixMultiplicationFP64Test>(params.matrixSize); });
+
+MatrixMultiplicationFP16Test::MatrixMultiplicationFP16Test(size_t matrixSize)
+	: GemmTest("matrix_multiplication_fp16_test", matrixSize) {}
+
+REGISTER_BENCHMARK("matrix_multiplication_fp16_test", TestCategory::GEMM, GEMM_TEST_MODES,
+	"Packed GEMM, FP16 inputs with FP32 accumulation",
+	[](const TestParams& params) { return std::make_unique<MatrixMultiplicationFP16Test>(params.matrixSize); });
+
+MatrixMultiplicationBF16Test::MatrixMultiplicationBF16Test(size_t matrixSize)
+	: GemmTest("matrix_multiplication_bf16_test", matrixSize) {}
+
+REGISTER_BENCHMARK("matrix_multiplication_bf16_test", TestCategory::GEMM, GEMM_TEST_MODES,
+	"Packed GEMM, BF16 inputs with FP32 accumulation",
+	[](const TestParams& params) { return std::make_unique<MatrixMultiplicationBF16Test>(params.matrixSize); });
+
+MatrixMultiplicationInt8Test::MatrixMultiplicationInt8Test(size_t matrixSize)
+	: GemmTest("matrix_multiplication_int8_test", matrixSize) {}
+
+REGISTER_BENCHMARK("matrix_multiplication_int8_test", TestCategory::GEMM, GEMM_TEST_MODES,
+	"Packed GEMM, u8 x s8 inputs with int32 accumulation",
+	[](const TestParams& params) { return std::make_unique<MatrixMultiplicationInt8Test>(params.matrixSize); });
+
+WorkPerIteration MatrixMultiplicationInt8Test::GetWork() const {
+	WorkPerIteration work = GemmTest::GetWork();
+	work.unit = WorkUnit::INT_OP;
+	return work;
+}
+
+
+/* Strassen Multiplication Test Class */
+StrassenMultiplicationTest::StrassenMultiplicationTest(size_t matrixSize, size_t cutoff)
+	: GemmTest("matrix_multiplication_strassen_test", matrixSize),
+	m_Cutoff(std::max<size_t>(cutoff, GEMM_MR))
 {
-	const size_t size = a.size();
-	const int numThreads = std::thread::hardware_concurrency();
-	std::vector<std::thread> threads;
-
-	const size_t rowsPerThread = size / numThreads;
-	for (int t = 0; t < numThreads; t++) {
-		size_t startRow = t * rowsPerThread;
-		size_t endRow = (t == numThreads - 1) ? size : startRow + rowsPerThread;
-		threads.emplace_back([&, startRow, endRow]() {
-			_BasicMultiplicationSingleThread(a, b, c, startRow, endRow); 
-		});
+}
+
+/* The harness-wide matrix_size default is far below where the recursion pays off, so this test defaults to STRASSEN_MIN_SIZE */
+static TestParams StrassenDefaults() {
+	TestParams defaults;
+	defaults.matrixSize = STRASSEN_MIN_SIZE;
+	return defaults;
+}
+
+REGISTER_BENCHMARK("matrix_multiplication_strassen_test", TestCategory::GEMM, GEMM_TEST_MODES,
+	"Strassen-Winograd FP32 GEMM over the packed kernel, cut off at strassen_cutoff",
+	[](const TestParams& params) { return std::make_unique<StrassenMultiplicationTest>(params.matrixSize, params.strassenCutoff); },
+	StrassenDefaults());
+
+void StrassenMultiplicationTest::SetUp() {
+	GemmTest::SetUp();
+	m_Reference = Matrix<float>(m_MatrixSize, m_MatrixSize);
+	Gemm::Multiply(m_A, m_B, m_Reference, 0, m_MatrixSize);
+	m_Arena.Reserve(Strassen::WorkspaceSize(m_MatrixSize, m_Cutoff));
+
+	LOG_DEBUG(m_Name + ": " + std::to_string(Strassen::RecursionDepth(m_MatrixSize, m_Cutoff)) + " recursion levels down to "
+		+ std::to_string(m_Cutoff) + ", " + std::to_string(m_Arena.Capacity() * sizeof(float) / (1024 * 1024)) + " MB workspace");
+}
+
+void StrassenMultiplicationTest::SetUpOpenLoop(int numThreads) {
+	GemmTest::SetUpOpenLoop(numThreads);
+	while (static_cast<int>(m_WorkerArenas.size()) < numThreads) {
+		m_WorkerArenas.emplace_back();
+		m_WorkerArenas.back().Reserve(Strassen::WorkspaceSize(m_MatrixSize, m_Cutoff));
 	}
+}
 
-	for (auto& thread : threads) {
-		thread.join();
+void StrassenMultiplicationTest::Verify() {
+	double maxError = 0.0;
+	double maxValue = 0.0;
+	for (size_t i = 0; i < m_MatrixSize; i++) {
+		const float* row = m_C.Row(i);
+		const float* reference = m_Reference.Row(i);
+		for (size_t j = 0; j < m_MatrixSize; j++) {
+			maxError = std::max(maxError, static_cast<double>(std::abs(row[j] - reference[j])));
+			maxValue = std::max(maxValue, static_cast<double>(std::abs(reference[j])));
+		}
 	}
+	m_MaxRelativeError = maxValue > 0.0 ? maxError / maxValue : maxError;
 
+	/* Around FP32 epsilon, which fixed notation would print as zero */
+	std::ostringstream error;
+	error << std::scientific << std::setprecision(3) << m_MaxRelativeError;
+	LOG_INFO(m_Name + " max relative error against the classical product: " + error.str());
+
+	/* Every level of the recursion can roughly triple the error of the classical product it replaces */
+	const double classicalBound = m_MatrixSize * std::numeric_limits<float>::epsilon();
+	const double tolerance = std::pow(3.0, Strassen::RecursionDepth(m_MatrixSize, m_Cutoff)) * classicalBound;
+	ExpectNear("max relative error against the classical product", m_MaxRelativeError, 0.0, tolerance);
 }
 
-void MatrixMultiplicationTest::_AVX2MultiplicationSingleThread(
-								const std::vector<std::vector<float>>& a,
-								const std::vector<std::vector<float>>& b,
-								std::vector<std::vector<float>>& c,
-								size_t startRow, size_t endRow)
-{
-	const size_t size = a.size();
-	for (size_t i = startRow; i < endRow; i++) {
-		for (size_t j = 0; j < size; j += 8) { // Process 8 elements using AVX2
-			__m256 sum = _mm256_setzero_ps();
-			for (size_t k = 0; k < size; k++) {
-				__m256 a_vec = _mm256_set1_ps(a[i][k]);
-				__m256 b_vec = _mm256_loadu_ps(&b[k][j]);
-				sum = _mm256_add_ps(sum, _mm256_mul_ps(a_vec, b_vec));
+void StrassenMultiplicationTest::TearDown() {
+	m_Reference = Matrix<float>();
+	m_Arena = StrassenArena();
+	m_WorkerArenas = std::vector<StrassenArena>();
+	GemmTest::TearDown();
+}
+
+void StrassenMultiplicationTest::Run() {
+	const StrassenLeafMultiply leaf = [](MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c) {
+		Gemm::Multiply(a, b, c, 0, c.Rows());
+	};
+	for (int64_t iter = 0; iter < m_IterationCount; ++iter)
+		Strassen::Multiply(m_A, m_B, m_C, m_Cutoff, m_Arena, leaf);
+}
+
+void StrassenMultiplicationTest::RunMultiThreaded(int numThreads) {
+	/* The block additions stay on the calling thread, every leaf product is tiled across the pool */
+	const StrassenLeafMultiply leaf = [this, numThreads](MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c) {
+		/* Leaves are never larger than the product, so the shared B sized in SetUp does not grow here */
+		Gemm::PrepareB(b.Rows(), b.Cols(), m_PackedB);
+		RunOnThreads(numThreads, [&](int t) {
+			Gemm::PackSharedB(b, m_PackedB, static_cast<size_t>(t), static_cast<size_t>(numThreads));
+		});
+
+		const GemmTiling tiling = Gemm::PlanTiles(c.Rows(), c.Cols(), numThreads);
+		WorkScheduler scheduler(ScheduleMode::STEALING, static_cast<int64_t>(tiling.Count()), numThreads, 1);
+		RunOnThreads(numThreads, [&](int t) {
+			int64_t begin = 0;
+			int64_t end = 0;
+			while (scheduler.NextChunk(t, begin, end)) {
+				for (int64_t tile = begin; tile < end; ++tile)
+					Gemm::MultiplyTile(a, m_PackedB, c, tiling, static_cast<size_t>(tile));
 			}
-			_mm256_storeu_ps(&c[i][j], sum);
-		}
+		});
+	};
+
+	if (m_RecordLatency)
+		PrepareLatencyHistograms(1);
+
+	for (int64_t iter = 0; iter < m_IterationCount; ++iter) {
+		const Timer::Stamp start = Timer::Start();
+		Strassen::Multiply(m_A, m_B, m_C, m_Cutoff, m_Arena, leaf);
+		if (m_RecordLatency)
+			m_LatencyHistograms[0].Record(Timer::Elapsed(start, Timer::Stop()).nanoseconds);
 	}
 }
 
-void MatrixMultiplicationTest::_AVX2MultiplicationMultiThread(
-								const std::vector<std::vector<float>>& a, 
-								const std::vector<std::vector<float>>& b, 
-								std::vector<std::vector<float>>& c)
+void StrassenMultiplicationTest::RunSingleIteration(ThreadContext& context) {
+	/* Open-loop workers run concurrently, so each thread has its own product and workspace, both allocated in SetUp */
+	Strassen::Multiply(m_A, m_B, m_WorkerC[context.threadIndex], m_Cutoff, m_WorkerArenas[context.threadIndex],
+		[](MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c) {
+			Gemm::Multiply(a, b, c, 0, c.Rows());
+		});
+}
+
+size_t StrassenMultiplicationTest::GetCutoff() const {
+	return m_Cutoff;
+}
+
+double StrassenMultiplicationTest::GetMaxRelativeError() const {
+	return m_MaxRelativeError;
+}
+
+
+/* Sparse Test Class */
+SparseTest::SparseTest(const std::string& testName, SparseFormat format, size_t denseColumns, const SparseProblem& problem)
+	: BenchmarkTest(testName),
+	m_Format(format),
+	m_DenseColumns(std::max<size_t>(denseColumns, 1)),
+	m_Problem(problem)
 {
-	const size_t size = a.size();
-	const int numThreads = std::thread::hardware_concurrency();
-	std::vector<std::thread> threads;
-
-	size_t rowsPerThread = size / numThreads;
-	for (int t = 0; t < numThreads; t++) {
-		size_t startRow = t * rowsPerThread;
-		size_t endRow = (t == numThreads - 1) ? size : startRow + rowsPerThread;
-		threads.emplace_back([&, startRow, endRow]() {
-			_AVX2MultiplicationSingleThread(a, b, c, startRow, endRow);
+	/* One iteration is a full product */
+	m_IterationCount = 1;
+}
+
+void SparseTest::SetUp() {
+	Xoshiro256 gen = Xoshiro256::Stream(m_Seed, SETUP_RANDOM_STREAM);
+	m_Csr = SparseGenerator::Generate(m_Problem.pattern, m_Problem.size, m_Problem.density, gen.Next());
+	if (m_Format == SparseFormat::SELL)
+		m_Sell = SellMatrix::FromCsr(m_Csr);
+
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	m_X.resize(m_Problem.size * m_DenseColumns);
+	for (float& x : m_X)
+		x = dist(gen);
+	m_Y.assign(m_Problem.size * m_DenseColumns, 0.0f);
+
+	/* Compulsory traffic: the matrix as stored (SELL padding included), the dense operand once and the result once */
+	m_BytesPerIteration = 2.0 * m_Problem.size * m_DenseColumns * sizeof(float);
+	std::string layout = SparseKernels::FormatToString(m_Format);
+	if (m_Format == SparseFormat::SELL) {
+		m_Nonzeros = m_Sell.nonzeros;
+		m_BytesPerIteration += m_Sell.StoredEntries() * (sizeof(float) + sizeof(int32_t))
+			+ m_Sell.sliceOffsets.size() * sizeof(int64_t) + m_Sell.rowOrder.size() * sizeof(int32_t);
+		layout += "-" + std::to_string(SELL_CHUNK_HEIGHT) + "-" + std::to_string(m_Sell.sigma) + ", "
+			+ std::to_string(100.0 * m_Nonzeros / std::max<size_t>(m_Sell.StoredEntries(), 1)) + "% of the stored entries are nonzeros";
+	}
+	else {
+		m_Nonzeros = m_Csr.Nonzeros();
+		m_BytesPerIteration += m_Csr.Nonzeros() * (sizeof(float) + sizeof(int32_t)) + m_Csr.rowOffsets.size() * sizeof(int64_t);
+	}
+
+	LOG_DEBUG(m_Name + ": " + SparseGenerator::PatternToString(m_Problem.pattern) + " " + std::to_string(m_Problem.size)
+		+ "^2 matrix with " + std::to_string(m_Nonzeros) + " nonzeros, " + layout + ", " + SparseKernels::GetKernelName() + " kernel");
+}
+
+void SparseTest::ResetTrial() {
+	std::fill(m_Y.begin(), m_Y.end(), std::numeric_limits<float>::quiet_NaN());
+}
+
+void SparseTest::SetUpOpenLoop(int numThreads) {
+	if (m_WorkerY.size() < static_cast<size_t>(numThreads))
+		m_WorkerY.resize(static_cast<size_t>(numThreads), std::vector<float>(m_Y.size(), 0.0f));
+}
+
+void SparseTest::TearDown() {
+	m_Csr = CsrMatrix();
+	m_Sell = SellMatrix();
+	m_X = std::vector<float>();
+	m_Y = std::vector<float>();
+	m_WorkerY = std::vector<std::vector<float>>();
+}
+
+void SparseTest::Run() {
+	for (int64_t iter = 0; iter < m_IterationCount; ++iter)
+		Multiply(0, RangeCount(), m_Y);
+}
+
+void SparseTest::RunMultiThreaded(int numThreads) {
+	/* Static nnz-balanced ranges, row lengths vary too much for equal row counts to balance */
+	const std::vector<size_t> bounds = SparseKernels::PartitionByNonzeros(RangeOffsets(), static_cast<size_t>(numThreads));
+
+	if (m_RecordLatency)
+		PrepareLatencyHistograms(1);
+
+	for (int64_t iter = 0; iter < m_IterationCount; ++iter) {
+		const Timer::Stamp start = Timer::Start();
+		RunOnThreads(numThreads, [&](int t) {
+			Multiply(bounds[t], bounds[t + 1], m_Y);
 		});
+		if (m_RecordLatency)
+			m_LatencyHistograms[0].Record(Timer::Elapsed(start, Timer::Stop()).nanoseconds);
 	}
+}
+
+void SparseTest::RunSingleIteration(ThreadContext& context) {
+	/* Open-loop workers call this concurrently, so each thread writes its own result */
+	Multiply(0, RangeCount(), m_WorkerY[context.threadIndex]);
+}
+
+void SparseTest::Verify() {
+	const double unitRoundoff = std::numeric_limits<float>::epsilon();
+	for (size_t i = 0; i < m_Csr.rows; i++) {
+		const int64_t length = m_Csr.rowOffsets[i + 1] - m_Csr.rowOffsets[i];
+		for (size_t j = 0; j < m_DenseColumns; j++) {
+			double reference = 0.0;
+			double magnitude = 0.0;
+			for (int64_t k = m_Csr.rowOffsets[i]; k < m_Csr.rowOffsets[i + 1]; k++) {
+				const double product = static_cast<double>(m_Csr.values[k]) * m_X[m_Csr.columns[k] * m_DenseColumns + j];
+				reference += product;
+				magnitude += std::abs(product);
+			}
+
+			const double actual = m_Y[i * m_DenseColumns + j];
+			const double tolerance = length * unitRoundoff * magnitude;
+			if (!NearlyEqual(actual, reference, tolerance))
+				ExpectNear("y(" + std::to_string(i) + ", " + std::to_string(j) + ")", actual, reference, tolerance);
+		}
+	}
+}
 
-	for (auto& thread : threads) {
-		thread.join();
+WorkPerIteration SparseTest::GetWork() const {
+	WorkPerIteration work;
+	work.unit = WorkUnit::FLOP;
+	work.amount = 2.0 * static_cast<double>(m_Nonzeros) * m_DenseColumns;
+	work.bytes = m_BytesPerIteration;
+	return work;
+}
+
+void SparseTest::Multiply(size_t begin, size_t end, std::vector<float>& y) const {
+	const size_t n = m_Problem.size;
+	if (m_DenseColumns == 1) {
+		if (m_Format == SparseFormat::SELL)
+			SparseKernels::SpmvSell(m_Sell, m_X.data(), y.data(), begin, end);
+		else
+			SparseKernels::SpmvCsr(m_Csr, m_X.data(), y.data(), begin, end);
+		return;
 	}
+
+	const MatrixView<const float> x(m_X.data(), n, m_DenseColumns, m_DenseColumns);
+	const MatrixView<float> out(y.data(), n, m_DenseColumns, m_DenseColumns);
+	if (m_Format == SparseFormat::SELL)
+		SparseKernels::SpmmSell(m_Sell, x, out, begin, end);
+	else
+		SparseKernels::SpmmCsr(m_Csr, x, out, begin, end);
 }
+
+size_t SparseTest::RangeCount() const {
+	return m_Format == SparseFormat::SELL ? m_Sell.Slices() : m_Csr.rows;
+}
+
+const std::vector<int64_t>& SparseTest::RangeOffsets() const {
+	return m_Format == SparseFormat::SELL ? m_Sell.sliceOffsets : m_Csr.rowOffsets;
+}
+
+SpmvCsrTest::SpmvCsrTest(const SparseProblem& problem)
+	: SparseTest("sparse_spmv_csr_test", SparseFormat::CSR, 1, problem) {}
+
+REGISTER_BENCHMARK("sparse_spmv_csr_test", TestCategory::SPARSE, BUILTIN_TEST_MODES,
+	"SpMV on a CSR matrix",
+	[](const TestParams& params) { return std::make_unique<SpmvCsrTest>(params.sparse); });
+
+SpmvSellTest::SpmvSellTest(const SparseProblem& problem)
+	: SparseTest("sparse_spmv_sell_test", SparseFormat::SELL, 1, problem) {}
+
+REGISTER_BENCHMARK("sparse_spmv_sell_test", TestCategory::SPARSE, BUILTIN_TEST_MODES,
+	"SpMV on a SELL-C-sigma matrix",
+	[](const TestParams& params) { return std::make_unique<SpmvSellTest>(params.sparse); });
+
+SpmmCsrTest::SpmmCsrTest(const SparseProblem& problem)
+	: SparseTest("sparse_spmm_csr_test", SparseFormat::CSR, SPARSE_SPMM_COLUMNS, problem) {}
+
+REGISTER_BENCHMARK("sparse_spmm_csr_test", TestCategory::SPARSE, BUILTIN_TEST_MODES,
+	"SpMM with 16 dense columns on a CSR matrix",
+	[](const TestParams& params) { return std::make_unique<SpmmCsrTest>(params.sparse); });
+
+SpmmSellTest::SpmmSellTest(const SparseProblem& problem)
+	: SparseTest("sparse_spmm_sell_test", SparseFormat::SELL, SPARSE_SPMM_COLUMNS, problem) {}
+
+REGISTER_BENCHMARK("sparse_spmm_sell_test", TestCategory::SPARSE, BUILTIN_TEST_MODES,
+	"SpMM with 16 dense columns on a SELL-C-sigma matrix",
+	[](const TestParams& params) { return std::make_unique<SpmmSellTest>(params.sparse); });
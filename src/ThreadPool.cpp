@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+#include "ThreadPool.hpp"
+#include "Affinity.hpp"
+#include "Logger.hpp"
+
+ThreadPool::ThreadPool(int numThreads, const std::vector<int>& cpuMapping) {
+	if (numThreads < 1) {
+		throw std::invalid_argument("ThreadPool requires at least one thread");
+	}
+
+	m_ThreadIds.resize(numThreads, 0);
+	m_PendingThreads = numThreads;
+
+	m_Workers.reserve(numThreads);
+	for (int i = 0; i < numThreads; ++i) {
+		int cpu = cpuMapping.empty() ? -1 : cpuMapping[i % cpuMapping.size()];
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this, i, cpu);
+	}
+
+	/* Wait until every worker has registered its thread id and parked */
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_DoneCondition.wait(lock, [this]() { return m_PendingThreads == 0; });
+	lock.unlock();
+	LOG_DEBUG("ThreadPool started with " + std::to_string(numThreads) + " workers");
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_ShouldExit = true;
+	}
+	m_StartCondition.notify_all();
+
+	for (auto& worker : m_Workers) {
+		if (worker.joinable())
+			worker.join();
+	}
+}
+
+void ThreadPool::Run(int numThreads, const Job& job) {
+	numThreads = std::clamp(numThreads, 1, GetSize());
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Job = &job;
+	m_ActiveThreads = numThreads;
+	m_PendingThreads = numThreads;
+	m_Error = nullptr;
+	++m_Generation;
+	lock.unlock();
+
+	/* Release every parked worker at once, the ones above numThreads go straight back to sleep */
+	m_StartCondition.notify_all();
+
+	lock.lock();
+	m_DoneCondition.wait(lock, [this]() { return m_PendingThreads == 0; });
+	m_Job = nullptr;
+
+	if (m_Error) {
+		std::exception_ptr error = m_Error;
+		m_Error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::Run(const Job& job) {
+	Run(GetSize(), job);
+}
+
+int ThreadPool::GetSize() const {
+	return static_cast<int>(m_Workers.size());
+}
+
+std::vector<int64_t> ThreadPool::GetThreadIds() const {
+	return m_ThreadIds;
+}
+
+void ThreadPool::WorkerLoop(int threadIndex, int cpu) {
+	if (cpu >= 0 && !ThreadPlacement::PinCurrentThread(cpu)) {
+		LOG_WARNING("Failed to pin worker " + std::to_string(threadIndex) + " to CPU " + std::to_string(cpu));
+	}
+
+	uint64_t seenGeneration = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+#if defined(__linux__)
+		m_ThreadIds[threadIndex] = static_cast<int64_t>(syscall(SYS_gettid));
+#endif
+		if (--m_PendingThreads == 0)
+			m_DoneCondition.notify_one();
+	}
+
+	while (true) {
+		const Job* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_StartCondition.wait(lock, [&]() { return m_ShouldExit || m_Generation != seenGeneration; });
+			if (m_ShouldExit)
+				return;
+
+			seenGeneration = m_Generation;
+			if (threadIndex >= m_ActiveThreads)
+				continue;
+			job = m_Job;
+		}
+
+		try {
+			(*job)(threadIndex);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_Error)
+				m_Error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_PendingThreads == 0)
+				m_DoneCondition.notify_one();
+		}
+	}
+}
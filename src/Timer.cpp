@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include "Timer.hpp"
+#include "Logger.hpp"
+
+#if !defined(_MSC_VER) && BENCHMARK_HAS_TSC
+	#include <cpuid.h>
+#endif
+
+bool Timer::s_InvariantTSC = false;
+double Timer::s_TscFrequencyHz = 0.0;
+int64_t Timer::s_OverheadNs = 0;
+uint64_t Timer::s_OverheadCycles = 0;
+
+void Timer::Calibrate() {
+	s_InvariantTSC = DetectInvariantTSC();
+	s_TscFrequencyHz = BENCHMARK_HAS_TSC ? MeasureTscFrequency() : 0.0;
+	s_OverheadNs = 0;
+	s_OverheadCycles = 0;
+
+	/* Overhead is the smallest back-to-back Start/Stop pair, taken in the same mode real measurements use */
+	int64_t minNs = std::numeric_limits<int64_t>::max();
+	uint64_t minCycles = std::numeric_limits<uint64_t>::max();
+	for (int i = 0; i < TIMER_CALIBRATION_SAMPLES; ++i) {
+		const Stamp start = Start();
+		const Stamp end = Stop();
+		TimingResult sample = Elapsed(start, end);
+		minNs = std::min(minNs, sample.nanoseconds);
+		minCycles = std::min(minCycles, sample.cycles);
+	}
+	s_OverheadNs = minNs;
+	s_OverheadCycles = minCycles;
+
+	LOG_INFO("Timer source: " + GetSourceName()
+		+ ", TSC frequency: " + std::to_string(s_TscFrequencyHz / 1e6) + " MHz"
+		+ ", overhead: " + std::to_string(s_OverheadNs) + " ns / " + std::to_string(s_OverheadCycles) + " cycles");
+}
+
+bool Timer::HasInvariantTSC() {
+	return s_InvariantTSC;
+}
+
+double Timer::GetTscFrequencyHz() {
+	return s_TscFrequencyHz;
+}
+
+int64_t Timer::GetOverheadNs() {
+	return s_OverheadNs;
+}
+
+uint64_t Timer::GetOverheadCycles() {
+	return s_OverheadCycles;
+}
+
+std::string Timer::GetSourceName() {
+	return (s_InvariantTSC && s_TscFrequencyHz > 0.0) ? "invariant TSC" : "steady_clock";
+}
+
+TimingResult Timer::Elapsed(const Stamp& start, const Stamp& end) {
+	TimingResult result;
+
+	const uint64_t cycles = end.cycles - start.cycles;
+	result.cycles = cycles > s_OverheadCycles ? cycles - s_OverheadCycles : 0;
+
+	if (s_InvariantTSC && s_TscFrequencyHz > 0.0) {
+		result.nanoseconds = static_cast<int64_t>(result.cycles * 1e9 / s_TscFrequencyHz);
+	}
+	else {
+		const int64_t nanoseconds = end.nanoseconds - start.nanoseconds;
+		result.nanoseconds = std::max<int64_t>(nanoseconds - s_OverheadNs, 0);
+	}
+	return result;
+}
+
+bool Timer::DetectInvariantTSC() {
+#if defined(_MSC_VER)
+	int cpu_info[4];
+	__cpuid(cpu_info, 0x80000000);
+	if (static_cast<unsigned int>(cpu_info[0]) < 0x80000007) return false;
+
+	__cpuid(cpu_info, 0x80000007);
+	return (cpu_info[3] & (1 << 8)) != 0; // Invariant TSC bit
+#elif BENCHMARK_HAS_TSC
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+		return (edx & (1 << 8)) != 0; // Invariant TSC bit
+	}
+	return false;
+#else
+	return false;
+#endif
+}
+
+double Timer::MeasureTscFrequency() {
+	/* Count TSC ticks across a sleep timed by steady_clock, keeping the best of three tries */
+	double best = 0.0;
+	for (int attempt = 0; attempt < 3; ++attempt) {
+		const int64_t startNs = NowNs();
+		const uint64_t startCycles = ReadCyclesBegin();
+		std::this_thread::sleep_for(TSC_CALIBRATION_INTERVAL);
+		const uint64_t endCycles = ReadCyclesEnd();
+		const int64_t endNs = NowNs();
+
+		if (endNs > startNs) {
+			const double frequency = (endCycles - startCycles) * 1e9 / static_cast<double>(endNs - startNs);
+			best = std::max(best, frequency);
+		}
+	}
+	return best;
+}